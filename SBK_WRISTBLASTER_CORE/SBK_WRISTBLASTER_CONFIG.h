@@ -74,6 +74,8 @@
 /*********************************************/
 // DEBUG TO SERIAL information about wrist blaster states and stagesthis engine controlled components
 // Uncomment/comment the following line to send/stop DEBUG_TO_SERIAL_CORE info to serial
+// Debug messages build Strings on the heap. Without debug, the engines storage is all static and the link fails
+// if anything still allocates (see SBK_WB_HeapCheck.h), the check is off when DEBUG_TO_SERIAL is defined.
 
 // #define DEBUG_TO_SERIAL
 
@@ -85,6 +87,18 @@
 #define DEBUG_PRINT(x)
 #endif
 
+#include "SBK_WB_HeapCheck.h"
+
+// BENCHMARK TO SERIAL : timing figures of some drivers are sent to serial at start-up
+// Uncomment/comment the following line to send/stop benchmarks to serial
+
+// #define BENCHMARK_TO_SERIAL
+
+// RANDOM FIXED SEED : the animations random draws are seeded at start-up from analog noise and the boot time,
+// each boot differs. Uncomment the following line to replay the same random sequence on every boot.
+
+// #define RANDOM_FIXED_SEED 0x2545F491UL
+
 #ifdef ARDUINO_AVR_NANO_EVERY
 #define DEBUG_BAUDRATE 115200
 #else
@@ -100,7 +114,8 @@
 // ARDUINO NANO EVERY PINS DEFINITION
 #define SW_RX_PIN 2     // If Software Serial is used, SoftSerial receiving pinto audio board Tx pin
 #define SW_TX_PIN 3     // If Software Serial is used, SoftSerial transmitting pin to audio board Rx pin
-#define BUSY_PIN 12     // Audio player BUSY pin - NOT USE IN THIS CODE
+                        // If Hardware Serial is used (see PLAYER_HARDWARE_SERIAL), Serial1 uses pins RX0 (0) and TX1 (1)
+#define BUSY_PIN 12     // Audio player BUSY pin - used only if BUSY_PIN_READY is enabled
 #define AMP_MUTE_PIN 13 // Onboard Amplifier mute pin - NOT USE IN THIS CODE
 // Bar Meter driver pins
 #define BM_DIN_PIN A4  // connected to bar meter driver DataIn pin / SDA in case of I2C driver
@@ -155,6 +170,8 @@ const uint16_t SMOKER_MIN_OFF_TIME = 10000; // in ms
 /*********************************************/
 #include "SBK_WB_BarMeterEngine.h"
 /* DEFINE BAR METER TOTAL NUMBER OF SEGEMENTS*/
+// Any length up to the driver matrix size (64 for MAX72xx, 128 for HT16K33), like the 24 segments Power Cell bar meter.
+// The BM_SEG_MAP mapping below must have exactly SEG_NUMBER entries.
 const uint8_t SEG_NUMBER = 28;
 const bool BM_DIRECTION = REVERSE; // animation direction (FORWARD/REVERSE)
 
@@ -162,9 +179,35 @@ const bool BM_DIRECTION = REVERSE; // animation direction (FORWARD/REVERSE)
 #define BM_MAX72xx // MAX7219/7221 uses 3 pins serial communication : data, clock, load.
 // #define BM_HT16K33 // I2C LEDs driver like Adafruit backpack, uses 2 pins : SDA, SDC.
 
+#ifdef BM_MAX72xx
+/* SELECT MAX72xx SERIAL TRANSPORT           */
+// MAX72xx_BITBANG   : Arduino shiftOut(), works on any pins (slowest)
+// MAX72xx_FAST_GPIO : direct port registers writes, works on any pins
+// MAX72xx_HW_SPI    : hardware SPI, BM_DIN_PIN and BM_CLK_PIN MUST be the MOSI (D11) and SCK (D13) pins,
+//                     falls back to MAX72xx_FAST_GPIO if they are not.
+// MAX72xx_FAST_GPIO and MAX72xx_HW_SPI are opt-in, check the wiring before selecting them.
+const MAX72xxTransport BM_TRANSPORT = MAX72xx_BITBANG;
+/* DEFINE NUMBER OF DAISY CHAINED MAX72xx     */
+// The bar meter is driven by the first one, the others are free for additional segment displays
+// (see setDisplayRow()), each row is latched on all devices at once.
+const uint8_t BM_DEVICES = 1;
+#endif
+
 #ifdef BM_HT16K33
 /* DEFINE DRIVER I2C ADDRESS IF REQUIRED     */
 #define BM_ADDRESS 0x70 // for I2C drivers type
+/* SELECT I2C BUS CLOCK                      */
+// HT16K33_I2C_STANDARD : 100kHz
+// HT16K33_I2C_FAST     : 400kHz, if the wiring to the driver is short enough
+const uint32_t BM_I2C_CLOCK = HT16K33_I2C_STANDARD;
+// Interrupt driven I2C frames : the main loop doesn't wait for the bar meter transfers (Arduino Nano Every only).
+// Opt-in with #define HT16K33_ASYNC in SBK_WB_HT16K33.h, the driver then owns the TWI0 interrupt.
+// The default is the blocking Wire library transfers.
+#ifdef HT16K33_ASYNC
+const bool BM_I2C_ASYNC = true;
+#else
+const bool BM_I2C_ASYNC = false;
+#endif
 #endif
 
 /*********************************************/
@@ -182,7 +225,7 @@ const bool BM_DIRECTION = REVERSE; // animation direction (FORWARD/REVERSE)
 //  MAPPING 1 matrix definition, more associated with common cathode SK bar meter
 //  This mapping works for this MAX72xx driver PCB "SBK_WB_BG_SK_PCB_Vx"
 //  with bar meter holder PCB "SBK_WB_BG_28SEG_PCB_Vx"
-const uint8_t BM_SEG_MAP[28][2] = {
+const uint8_t BM_SEG_MAP[SEG_NUMBER][2] = {
     {0, 0}, // SEG #1
     {0, 1}, // SEG #2
     {0, 2}, // SEG #3
@@ -216,7 +259,7 @@ const uint8_t BM_SEG_MAP[28][2] = {
 //  MAPPING 2 matrix definition, more associated with common cathode SA bar meter
 //  This mapping works for this MAX72xx driver PCB "SBK_WB_BG_SA_PCB_Vx"
 //  with bar meter holder PCB "SBK_WB_BG_28SEG_PCB_Vx"
-const uint8_t BM_SEG_MAP[28][2] = {
+const uint8_t BM_SEG_MAP[SEG_NUMBER][2] = {
     {0, 0}, // SEG #1
     {1, 0}, // SEG #2
     {2, 0}, // SEG #3
@@ -253,6 +296,12 @@ const uint8_t BM_SEG_MAP[28][2] = {
 /*********************************************/
 #include "SBK_WB_LedsStripBaseEngine.h"
 const uint8_t TOTAL_LEDS_NUMBER = 19; // vent + indicators + firing jewel + cyclotron total WS21812 pixels
+// Render tick : engines animations step and the chain is pushed at most once per frame.
+// Each push blocks interrupts for ~30us per pixel, 100Hz is plenty for the animations.
+const uint16_t LEDS_FRAME_RATE = 100; // Hz
+// A push is held while the audio player serial line is busy (interrupts masked by the push corrupt
+// SoftwareSerial bytes), but never more than this number of frames in a row.
+const uint8_t LEDS_MAX_DEFERRED_FRAMES = 3;
 /***********************************************/
 /*             LEDS INDEX                 */
 /***********************************************/
@@ -268,6 +317,14 @@ const uint8_t LED_INDEX_TIP_1ST = 5;
 const uint8_t LED_INDEX_TIP_LAST = 11;
 const uint8_t LED_INDEX_CYC_START = 12;
 const uint8_t LED_INDEX_CYC_END = 18;
+// Expected push time (us, interrupts masked) of a frame where an element changes : the chain is only clocked out
+// up to the last changed pixel, so fast changing elements (firing rod, cyclotron, flickering vent) cost less
+// early in the chain. A frame costs the push time of its furthest changed element.
+const uint16_t LEDS_PUSH_US_INDICATORS = WS2812_PUSH_US(max(max(LED_INDEX_SLOWBLOW, LED_INDEX_TOP_YELLOW), max(LED_INDEX_TOP_WHITE, LED_INDEX_FRONT_ORANGE)) + 1);
+const uint16_t LEDS_PUSH_US_VENT = WS2812_PUSH_US(LED_INDEX_VENT + 1);
+const uint16_t LEDS_PUSH_US_FIRING_ROD = WS2812_PUSH_US(LED_INDEX_TIP_LAST + 1);
+const uint16_t LEDS_PUSH_US_CYCLOTRON = WS2812_PUSH_US(LED_INDEX_CYC_END + 1);
+const uint16_t LEDS_PUSH_US_FULL = WS2812_PUSH_US(TOTAL_LEDS_NUMBER);
 /***********************************************/
 /*                  VENT LED                   */
 /***********************************************/
@@ -284,6 +341,14 @@ const uint8_t CYC_NUMLEDS = 7;
 const uint8_t CYC_RING_1ST = 0;
 const uint8_t CYC_RING_LAST = 5;
 const uint8_t CYC_CENTER = 6;
+// Cyclotron rings : a ring is a run of pixels from the cyclotron start, {first, last, speed, reverse},
+// speed is relative to the cyclotron speed in 1/16 (16 : same speed), each ring keeps its own rotation phase.
+// Additional rings (mini cyclotron, power cell ring...) can be chained after the jewel, extend CYC_NUMLEDS and
+// LED_INDEX_CYC_END accordingly, e.g. {7, 18, 8, true} for a 12 pixels ring turning the other way at half speed.
+// Set CYC_CENTER to CYC_NO_CENTER if there is no center pixel.
+const uint8_t CYC_RINGS_NUMBER = 1;
+const CycRing CYC_RINGS[CYC_RINGS_NUMBER] = {
+    {CYC_RING_1ST, CYC_RING_LAST, 16, false}};
 /***********************************************/
 /*               FIRE ROD LEDs                */
 /***********************************************/
@@ -317,12 +382,26 @@ const bool FIRE_BUTTON_LED_READY = ENABLE;
 /*    AUDIO PLAYER definition and helpers    */
 /*                                           */
 /*********************************************/
+// AUDIO PLAYER SERIAL TRANSPORT
+// SoftwareSerial keeps the CPU busy for every bit sent, about 10ms for a 10 bytes player command at 9600 bauds,
+// and can't receive while the LEDs chain is pushed : the LEDs pushes are held while the player may answer.
+// The Nano Every has a spare hardware serial, Serial1 on pins RX0/TX1 : sending and receiving are interrupts driven
+// with buffers, a command costs some tens of micro seconds and the LEDs pushes don't have to wait.
+// Uncomment/comment the following line to use the hardware serial / SoftwareSerial on SW_RX_PIN and SW_TX_PIN :
+// #define PLAYER_HARDWARE_SERIAL Serial1
+#ifndef PLAYER_HARDWARE_SERIAL
 #include <SoftwareSerial.h>
+#endif
 #include "SBK_WB_PlayerEngine.h"
 const uint8_t VOLUME_MAX = 30;            // 0-30 If you want to reduce the maximum possible volume according to your amp module, set this here
 const uint8_t VOLUME_START = 20;          // 0-30 Volume at star-up, will not change if volume potentiometer doesn't exist
 const uint8_t PLAYER_COMMAND_DELAY = 150; // short delay between query/ commands : some player(s) will behave weirdly if there is no delay
 const uint16_t PLAYER_BAUDRATE = 9600; // Native baudrate is 9600 for this player.
+const uint8_t PLAYER_REPLY_WINDOW = 30; // ms after a command while the player may answer, LEDs pushes are held meanwhile
+// ACK PACING : commands are sent with feedback and the next one is sent as soon as the player acknowledges the previous one,
+// usually some tens of ms. PLAYER_COMMAND_DELAY is then only the timeout if an acknowledge is lost.
+// Needs the player TX wired to the board RX. Set to DISABLE to space all commands by PLAYER_COMMAND_DELAY.
+const bool PLAYER_ACK_PACING = DISABLE;
 // AUDIO ADVANCE
 // A short advance to call the next track before the real ending :
 // DFPlayer doesn't like when a command is call exactly at the end of a file,
@@ -330,11 +409,13 @@ const uint16_t PLAYER_BAUDRATE = 9600; // Native baudrate is 9600 for this playe
 // If you got erratic playing behaviours, try to increase this advance a bit at the time :
 // if it's too much, it's gonna cut the tracks a bit in the end...
 const uint8_t AUDIO_ADVANCE = 40; // 25-50ms
-// USING BUSY PIN INSTEAD OF TRACK LENGTHS
-// Uses Busy Pin instead of track length in the logic.
-// There is a small moment at the end of a playing track when the player is not responding to command.
-// Using Busy Pin sometime make the play commands fall into that moment and cause erratic play commands.
-const bool BUSY_PIN_READY = DISABLE;   // ENABLING NOT RECOMMANDED : this option is left there for coders who would like to eplore this avenue...
+// USING BUSY PIN WITH TRACK LENGTHS
+// Uses Busy Pin edges, caught by a pin change interrupt and filtered from glitches, with the track lengths in the logic :
+// a track start is taken at the Busy Pin falling edge and its end is predicted from there with the track length and the
+// audio advance, or taken at the Busy Pin rising edge if the track is shorter.
+// There is a small moment at the end of a playing track when the player is not responding to command,
+// the commands are held for a short guard time after the Busy Pin rising edge.
+const bool BUSY_PIN_READY = DISABLE;   // Enable only if the player BUSY pin is wired to BUSY_PIN
 // VOLUME POTENTIOMETER :
 // If you have no volume potentiometer hooked to the VOL_POT_PIN, disable this feature.
 // If enabled and no pot on the pin, volume will change erraticly.
@@ -428,6 +509,20 @@ const bool TRACK_LOOPING[] = {
     false  // track #18, no loop, STATE_POWER_OFF
 };
 
+/****************************************/
+/*     SOUND FX TRACKS CALIBRATION      */
+/****************************************/
+/* The tracks lengths above can be measured on the player and saved to EEPROM : enable TRACKS_CALIBRATION, upload, */
+/* power the blaster and let it play every track once (with BENCHMARK_TO_SERIAL the measures are sent to serial). */
+/* Then disable TRACKS_CALIBRATION and upload again : the measured lengths are loaded from EEPROM at start-up,   */
+/* the TRACK_LENGTH values are only used if no valid measures are saved.                                           */
+/* Measures use the BUSY pin if BUSY_PIN_READY is enabled, else the player "track finished" serial reply.           */
+#include "SBK_WB_TrackTable.h"
+const bool TRACKS_CALIBRATION = DISABLE;
+const uint8_t TRACKS_NUMBER = sizeof(TRACK_LENGTH) / sizeof(TRACK_LENGTH[0]);
+const uint16_t TRACK_TABLE_EEPROM_ADDRESS = 0; // EEPROM bytes used : TRACK_TABLE_EEPROM_SIZE(TRACKS_NUMBER)
+const uint16_t TRACK_CALIBRATION_TIMEOUT = 60000; // ms, a track not ended by then keeps its TRACK_LENGTH value
+
 /*******************************/
 /* SOME STATE/STAGE PARAMETERS */
 /*******************************/
@@ -120,6 +120,7 @@ BlasterState prevState = STATE_ZERO;    // State tracking for some sequences
 uint8_t stageFlag = 0;                  // stage flag to implement different state stages in main loop
 uint8_t prevStageFlag = 100;            // stage flag tracking
 uint32_t stateStartTime = 0;            // general time tracker for functions timers and delays
+bool stateStartOnTrack = false;         // stateStartTime to be taken when the player sends the state track command
 int8_t playingTrack = -1;               // Record the actual track playing
 uint8_t heatLevel = 0;                  // Tracker for overheat
 uint32_t heatLevelPrevUpdate = 0;       // Tracker for overheat
@@ -133,6 +134,9 @@ bool checkIfTimerExit(uint16_t time, BlasterState next_state);      // check if
 void getLEDsSchemeForThisState();                                   // This function contains animations settings and calling for all states
 void playThisStateTrack();                                          // play state track
 void playThisTrack(uint8_t track);                                  // Play specific track other then state strack
+void calibrateTrackLengths();                                       // Measure every state track length and save them to EEPROM
+uint32_t getRandomSeed();                                           // Boot dependent seed for the animations random draws
+void printBenchmarkStats();                                         // Frames and player statistics to serial (BENCHMARK_TO_SERIAL)
 bool checkPlayModeForThisState();                                   // check if play mode is correct for this state (looping / not looping)
 uint16_t getDuration();                                             // Get actual state duration
 uint16_t getSpecificDuration(BlasterState state);                   // Get duration of a specific state
@@ -151,16 +155,17 @@ bool getPartyModeState();                                           // Helper to
 //  Bar meter helper variables for 28 segements bar meter:
 //  DRIVER type, animations DIRECTION and segments MAPPING should be defined in SBK_WRISTBLASTER_CONFIG.h file
 #ifdef BM_MAX72xx
-MAX72xxDriver barmeter(&SEG_NUMBER, &BM_DIRECTION, BM_DIN_PIN, BM_CLK_PIN, BM_LOAD_PIN, BM_SEG_MAP);
+MAX72xxBarMeter<SEG_NUMBER, BM_DEVICES> barmeter(&BM_DIRECTION, BM_DIN_PIN, BM_CLK_PIN, BM_LOAD_PIN, BM_SEG_MAP, BM_TRANSPORT);
 #elif defined(BM_HT16K33)
-HT16K33Driver barmeter(&SEG_NUMBER, &BM_DIRECTION, BM_DIN_PIN, BM_CLK_PIN, BM_ADDRESS, BM_MAPPING);
+HT16K33BarMeter<SEG_NUMBER> barmeter(&BM_DIRECTION, BM_DIN_PIN, BM_CLK_PIN, BM_ADDRESS, BM_SEG_MAP, BM_I2C_CLOCK, BM_I2C_ASYNC);
 #endif
 
 /***********************************************/
 /*               WS2812 LEDs strip             */
 /***********************************************/
 //  LEDs index, positions and animations directions should be defined in SBK_WRISTBLASTER_CONFIG.h file
-Adafruit_NeoPixel blasterLeds = Adafruit_NeoPixel(TOTAL_LEDS_NUMBER, LEDS_PIN, NEO_GRB + NEO_KHZ800);
+WS2812Chain<TOTAL_LEDS_NUMBER> blasterLeds(LEDS_PIN, NEO_GRB + NEO_KHZ800);
+FrameScheduler ledsFrames(LEDS_FRAME_RATE, LEDS_MAX_DEFERRED_FRAMES);
 
 FiringRod firingRod(&blasterLeds,
                     FIRE_ROD_POT_PIN, HUE_POT_READY,
@@ -170,10 +175,10 @@ Indicator slowBlowIndicator(&blasterLeds, &LED_INDEX_SLOWBLOW, "IND_SlBlw");
 Indicator topYellowIndicator(&blasterLeds, &LED_INDEX_TOP_YELLOW, "IND_topYw");
 Indicator topWhiteIndicator(&blasterLeds, &LED_INDEX_TOP_WHITE, "IND_topWh");
 Indicator frontOrangeIndicator(&blasterLeds, &LED_INDEX_FRONT_ORANGE, "IND_frOr");
-Cyclotron cyclotron(&blasterLeds,
-                    &CYC_NUMLEDS, &LED_INDEX_CYC_START, &LED_INDEX_CYC_END,
-                    &CYC_RING_1ST, &CYC_RING_LAST, &CYC_CENTER,
-                    &CYCLOTRON_DIRECTION);
+CyclotronRings<CYC_RINGS_NUMBER> cyclotron(&blasterLeds,
+                                           &CYC_NUMLEDS, &LED_INDEX_CYC_START, &LED_INDEX_CYC_END,
+                                           CYC_RINGS, &CYC_CENTER,
+                                           &CYCLOTRON_DIRECTION);
 
 /***********************************************/
 /*      Fire button Single Led Indicator       */
@@ -196,11 +201,26 @@ Player player(VOLUME_MAX, VOLUME_START,
               VOL_POT_PIN, VOL_POT_READY,
               PLAYER_COMMAND_DELAY,
               AUDIO_ADVANCE,
-              BUSY_PIN_READY);
+              BUSY_PIN_READY,
+              PLAYER_REPLY_WINDOW);
+// Tracks lengths, measured ones from EEPROM or TRACK_LENGTH from SBK_WRISTBLASTER_CONFIG.h
+TrackLengths<TRACKS_NUMBER> trackLengths(TRACK_LENGTH, TRACK_TABLE_EEPROM_ADDRESS);
 /************************************/
 /* Audio board SERIAL COMMUNICATION */
 /************************************/
+// Serial transport selected with PLAYER_HARDWARE_SERIAL in SBK_WRISTBLASTER_CONFIG.h
+#ifdef PLAYER_HARDWARE_SERIAL
+#define PlayerSerial PLAYER_HARDWARE_SERIAL
+#define PLAYER_SERIAL_IS_HARDWARE true
+#else
 SoftwareSerial SoftSerial(SW_RX_PIN, SW_TX_PIN);
+#define PlayerSerial SoftSerial
+#define PLAYER_SERIAL_IS_HARDWARE false
+#endif
+#ifdef BENCHMARK_TO_SERIAL
+uint32_t firstLedsFrameTime = 0; // ms from power up to the first LEDs frame pushed by the main loop
+bool bootReported = false;
+#endif
 
 /*********************************************/
 /*                                           */
@@ -227,15 +247,19 @@ void setup(void)
 {
 
 // Setup Serial.com for troubleshotting OR audio board communication
-#ifdef DEBUG_TO_SERIAL
+#if defined(DEBUG_TO_SERIAL) || defined(BENCHMARK_TO_SERIAL)
   Serial.begin(DEBUG_BAUDRATE);
 #endif
 
+  // Tracks lengths : calibrated lengths from EEPROM, else config lengths
+  trackLengths.begin();
+
   // Audio player setup
-  // Uses Software Serial, pins should be define in SBK_WRISTBLASTER_CONFIG.h
+  // Uses Software Serial or Hardware Serial, transport and pins should be define in SBK_WRISTBLASTER_CONFIG.h
   // Baudrate should be set according to your audio player native baudrate.
-  SoftSerial.begin(PLAYER_BAUDRATE);
-  if (!player.begin(SoftSerial))
+  // The player setup commands are sent in background by player.update(), the prop comes up without waiting for them.
+  PlayerSerial.begin(PLAYER_BAUDRATE);
+  if (!player.begin(PlayerSerial, PLAYER_SERIAL_IS_HARDWARE, PLAYER_ACK_PACING))
     DEBUG_PRINTLN("Init failed, please check the wire connection!");
 
   // Enable/disable software volume control with potentiometer
@@ -246,8 +270,23 @@ void setup(void)
   blasterLeds.setBrightness(255);
   blasterLeds.clear();
   blasterLeds.show();
+  ledsFrames.begin();
   // Setup LEDs strip animations :
   cyclotron.begin();
+#ifdef BENCHMARK_TO_SERIAL
+  cyclotron.benchmark(Serial, 100);
+  // Expected push time of the LEDs layout, see LED_INDEX_* in SBK_WRISTBLASTER_CONFIG.h
+  Serial.print("WS2812 push us, indicators : ");
+  Serial.print(LEDS_PUSH_US_INDICATORS);
+  Serial.print("  vent : ");
+  Serial.print(LEDS_PUSH_US_VENT);
+  Serial.print("  firing rod : ");
+  Serial.print(LEDS_PUSH_US_FIRING_ROD);
+  Serial.print("  cyclotron : ");
+  Serial.print(LEDS_PUSH_US_CYCLOTRON);
+  Serial.print("  full chain : ");
+  Serial.println(LEDS_PUSH_US_FULL);
+#endif
   vent.begin();
   slowBlowIndicator.begin();
   topWhiteIndicator.begin();
@@ -261,6 +300,9 @@ void setup(void)
   barmeter.begin();
   barmeter.clear();
   barmeter.update();
+#if defined(BENCHMARK_TO_SERIAL) && defined(BM_MAX72xx)
+  barmeter.benchmark(Serial, 500);
+#endif
 
   // setup for the switches/buttons
   SWactivate.begin();
@@ -271,6 +313,17 @@ void setup(void)
 
   // Smoker setup
   smoker.begin(DISABLE);
+
+  // Animations random draws, see RANDOM_FIXED_SEED in SBK_WRISTBLASTER_CONFIG.h
+#ifdef RANDOM_FIXED_SEED
+  FastRandom::seed(RANDOM_FIXED_SEED);
+#else
+  FastRandom::seed(getRandomSeed());
+#endif
+
+  // Tracks calibration mode, see TRACKS_CALIBRATION in SBK_WRISTBLASTER_CONFIG.h
+  if (TRACKS_CALIBRATION)
+    calibrateTrackLengths();
 }
 /******************** END_SEQ SETUP LOOP ********************/
 
@@ -310,17 +363,31 @@ void loop()
   // Update simple LEDs states to last animations schemes.
   barmeter.update(currentTime);
   fireButtonSingleLed.update(currentTime);
-  // Update addressable LEDs chain with last color schemes.
-  bool update_leds_chain = false;
-  update_leds_chain |= slowBlowIndicator.update(currentTime);
-  update_leds_chain |= topWhiteIndicator.update(currentTime);
-  update_leds_chain |= topYellowIndicator.update(currentTime);
-  update_leds_chain |= frontOrangeIndicator.update(currentTime);
-  update_leds_chain |= cyclotron.update(currentTime);
-  update_leds_chain |= vent.update(currentTime);
-  update_leds_chain |= firingRod.update(currentTime);
-  if (update_leds_chain) // Update only if required
-    blasterLeds.show();
+  // Update addressable LEDs chain with last color schemes, once per render tick :
+  // the engines clocks only move on the tick so their animations render at most once per frame.
+  if (ledsFrames.tick())
+  {
+    slowBlowIndicator.update(currentTime);
+    topWhiteIndicator.update(currentTime);
+    topYellowIndicator.update(currentTime);
+    frontOrangeIndicator.update(currentTime);
+    cyclotron.update(currentTime);
+    vent.update(currentTime);
+    firingRod.update(currentTime);
+    // Update only if required, a deferred frame stays dirty in the chain framebuffer
+    bool update_leds_chain = blasterLeds.isDirty();
+    if (update_leds_chain && !player.isSerialQuiet() && ledsFrames.defer()) // Hold the push while the player talks
+      update_leds_chain = false;
+    if (update_leds_chain)
+      blasterLeds.show();
+    ledsFrames.frameDone(update_leds_chain);
+#ifdef BENCHMARK_TO_SERIAL
+    if (update_leds_chain && firstLedsFrameTime == 0)
+      firstLedsFrameTime = millis();
+    if (ledsFrames.getFrames() >= 5 * LEDS_FRAME_RATE) // Every ~5 seconds
+      printBenchmarkStats();
+#endif
+  }
 
   // Check buttons and switches readings and states
   PBintensify.update(currentTime);
@@ -335,9 +402,24 @@ void loop()
   // DFPlayer Mini Management
   player.update(currentTime);
   player.setVolWithPot(); // Set audio volume with potentiometer
-  // Ensure command Delay is done before any other action
-  if (!player.checkCommandDelay())
-    return;
+  // The state timers start when the state track command is actually sent, not when it is queued
+  if (stateStartOnTrack && !player.isTrackCommandPending())
+  {
+    stateStartTime = player.getTrackCommandTime();
+    stateStartOnTrack = false;
+  }
+#ifdef BENCHMARK_TO_SERIAL
+  if (!bootReported && player.isReady() && firstLedsFrameTime)
+  {
+    Serial.print("Boot, first LEDs frame : ");
+    Serial.print(firstLedsFrameTime);
+    Serial.print(" ms  player ready : ");
+    Serial.print(player.getReadyTime());
+    Serial.println(" ms after begin");
+    bootReported = true;
+  }
+#endif
+  // Player commands are queued and spaced by the player engine itself, the states logic keeps running
 
   ///////////////////////////////////////////////////////////////
   // Actions for different blaster states
@@ -362,6 +444,7 @@ void loop()
 
       // Standard initializers
       stateStartTime = currentTime;
+      stateStartOnTrack = false;
       stageFlag = 1; // End state initialization when stageFlag is 1
 
       DEBUG_PRINTLN();
@@ -485,6 +568,7 @@ void loop()
 
       // Standard initializers
       stateStartTime = currentTime;
+      stateStartOnTrack = false;
       stageFlag = 1; // End state initialization when stageFlag is 1
 
       DEBUG_PRINTLN();
@@ -752,11 +836,7 @@ void loop()
       // Wrist blaster state LEDs animations
       getLEDsSchemeForThisState();
 
-      // Ensure command Delay is done before any other action
-      if (!player.checkCommandDelay())
-        break;
-
-      // Enable/disable the track looping play mode if required, if updated break the loop to check command delay again
+      // Enable/disable the track looping play mode if required, if updated break the loop
       // Must be called after the play command in the initialization stage 0...
       if (checkPlayModeForThisState())
         break;
@@ -1069,6 +1149,7 @@ void loop()
 
       // Standard initializers
       stateStartTime = currentTime;
+      stateStartOnTrack = false;
       stageFlag = 3;
 
       DEBUG_PRINTLN();
@@ -1141,7 +1222,7 @@ void loop()
       //   break;
 
       // Check if tail track is done
-      if (!player.isPlaying()) // || (currentTime - stateStartTime) >= TRACK_LENGTH[WBstate])
+      if (!player.isPlaying()) // || (currentTime - stateStartTime) >= trackLengths.get(WBstate))
       {
         // If tailing is done goes into POWER OFF, or into cyclotron ON or FULL depending of the fireing type
         WBstate = fireType ? STATE_CYCLOTRON_FULL_POWER : STATE_CYCLOTRON_ON;
@@ -2101,21 +2182,22 @@ uint8_t stateInitialization() // Standard initializers for most state
 {
   playThisStateTrack();
   stateStartTime = currentTime;
+  stateStartOnTrack = true; // Moved to the track command send time by the main loop
   return 1; // End state initialization when stageFlag is 1
 }
 
 void playThisStateTrack()
 {
-  if (TRACK_LENGTH[WBstate] == 0)
+  if (trackLengths.get(WBstate) == 0)
     player.stop();
   else
     TRACK_LOOPING[WBstate] ? player.loopFileNum(WBstate)
-                           : player.playFileNum(WBstate, TRACK_LENGTH[WBstate]);
+                           : player.playFileNum(WBstate, trackLengths.get(WBstate));
 
   playingTrack = WBstate;
 
   DEBUG_PRINTLN("Track: " + String(WBstate) + "  length: " +
-                String(TRACK_LENGTH[WBstate]) +
+                String(trackLengths.get(WBstate)) +
                 " Loop required: " + String(TRACK_LOOPING[WBstate]));
 }
 
@@ -2123,15 +2205,109 @@ void playThisTrack(uint8_t track)
 {
 
   TRACK_LOOPING[track] ? player.loopFileNum(track)
-                       : player.playFileNum(track, TRACK_LENGTH[track]);
+                       : player.playFileNum(track, trackLengths.get(track));
 
   playingTrack = track;
 
   DEBUG_PRINTLN("Track: " + String(track) + "  length: " +
-                String(TRACK_LENGTH[track]) +
+                String(trackLengths.get(track)) +
                 " Loop required: " + String(TRACK_LOOPING[track]));
 }
 
+void calibrateTrackLengths()
+{
+  // Wait for the player boot sequence
+  while (!player.isReady())
+    player.update(millis());
+
+  for (uint8_t track = 1; track < TRACKS_NUMBER; track++)
+  {
+    if (TRACK_LENGTH[track] == 0)
+      continue; // No track for this state
+
+    // Played once even if it's a looping track, its length is taken at the track end
+    player.playFileNum(track, TRACK_CALIBRATION_TIMEOUT);
+    while (player.getQueuedCommands())
+      player.update(millis());
+
+    uint32_t startTime = millis();
+    while (!player.isTrackLengthMeasured() && millis() - startTime < TRACK_CALIBRATION_TIMEOUT)
+      player.update(millis());
+
+    if (player.isTrackLengthMeasured())
+      trackLengths.set(track, player.getLastTrackLength());
+
+#ifdef BENCHMARK_TO_SERIAL
+    Serial.print("Track #");
+    Serial.print(track);
+    Serial.print(" config length : ");
+    Serial.print(TRACK_LENGTH[track]);
+    Serial.print(" ms  measured : ");
+    if (player.isTrackLengthMeasured())
+    {
+      Serial.print(player.getLastTrackLength());
+      Serial.println(" ms");
+    }
+    else
+      Serial.println("timeout");
+#endif
+  }
+
+  player.stop();
+  trackLengths.save();
+}
+
+#ifdef BENCHMARK_TO_SERIAL
+void printBenchmarkStats()
+{
+  ledsFrames.printStats(Serial);
+  Serial.print("Player frames : ");
+  Serial.print(player.getReceivedFrames());
+  Serial.print("  corrupted : ");
+  Serial.print(player.getCorruptedFrames());
+  Serial.print("  retried commands : ");
+  Serial.println(player.getRetriedCommands());
+  Serial.print("Player queue coalesced : ");
+  Serial.print(player.getCoalescedCommands());
+  Serial.print("  dropped : ");
+  Serial.print(player.getDroppedCommands());
+  Serial.print("  max delay : ");
+  Serial.print(player.getMaxQueueDelay());
+  Serial.println(" ms");
+  Serial.print(PLAYER_SERIAL_IS_HARDWARE ? "Player hardware serial" : "Player software serial");
+  Serial.print(", command CPU time avg/max : ");
+  Serial.print(player.getAvgCommandTime());
+  Serial.print("/");
+  Serial.print(player.getMaxCommandTime());
+  Serial.print(" us  max ack time : ");
+  Serial.print(player.getMaxAckTime());
+  Serial.print(" ms  ack timeouts : ");
+  Serial.println(player.getAckTimeouts());
+  if (BUSY_PIN_READY)
+  {
+    Serial.print("Player BUSY glitches : ");
+    Serial.print(player.getBusyGlitches());
+    Serial.print("  last track length : ");
+    Serial.print(player.getLastTrackLength());
+    Serial.println(" ms");
+  }
+  ledsFrames.resetStats();
+}
+#endif
+
+uint32_t getRandomSeed()
+{
+  // No analog pin is left unconnected : the potentiometers readings low bits noise is mixed with the boot time,
+  // which varies with the audio player and LEDs setup timings.
+  uint32_t seed = micros();
+  for (uint8_t i = 0; i < 16; i++)
+  {
+    seed = (seed << 2) | (seed >> 30);
+    seed ^= analogRead(VOL_POT_PIN) ^ (analogRead(FIRE_ROD_POT_PIN) << 1);
+  }
+  return seed ^ micros();
+}
+
 bool checkPlayModeForThisState()
 {
   bool shouldLoop = TRACK_LOOPING[WBstate];
@@ -2151,13 +2327,13 @@ bool checkPlayModeForThisState()
 uint16_t getDuration() // Get track duration for the actual state
 {
   uint8_t buffer = 0;
-  return (TRACK_LENGTH[WBstate] - AUDIO_ADVANCE - buffer);
+  return (trackLengths.get(WBstate) - AUDIO_ADVANCE - buffer);
 }
 
 uint16_t getSpecificDuration(BlasterState state)
 { // Get track duration for a specific state
   uint8_t buffer = 0;
-  return (TRACK_LENGTH[state] - AUDIO_ADVANCE - buffer);
+  return (trackLengths.get(state) - AUDIO_ADVANCE - buffer);
 }
 
 void checkNextPreviousButton()
@@ -2218,8 +2394,8 @@ void heatLevelRisingBurst() // Increase heat level every 250ms, about 25secondes
 
 uint8_t getCaptureScaledDuration()
 {
-  uint16_t maxDuration = constrain(DURATION_CAPTURE_MAX, 10000, TRACK_LENGTH[STATE_CAPTURE]);
-  uint16_t warningDuration = TRACK_LENGTH[STATE_CAPTURE_WARNING_OVERHEAT] - DURATION_CAPTURE_OVERHEAT;
+  uint16_t maxDuration = constrain(DURATION_CAPTURE_MAX, 10000, trackLengths.get(STATE_CAPTURE));
+  uint16_t warningDuration = trackLengths.get(STATE_CAPTURE_WARNING_OVERHEAT) - DURATION_CAPTURE_OVERHEAT;
   return round(100.0 * (maxDuration - warningDuration) / maxDuration);
 }
 
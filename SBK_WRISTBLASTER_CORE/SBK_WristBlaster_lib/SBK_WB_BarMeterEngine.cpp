@@ -30,24 +30,24 @@
 
 
 
-BarMeterAnimation::BarMeterAnimation(const uint8_t *segNumber)
-    : P_SEG_NUMBER(segNumber),
+BarMeterAnimation::BarMeterAnimation(uint8_t segNumber, uint32_t *states)
+    : _SEG_NUMBER(segNumber),
+      _STATE_WORDS(BM_STATE_WORDS(segNumber)),
       _currentTime(0),
-      _ledsStatesLow(0),
-      _ledsStatesHigh(0),
+      _prevUpdate(0),
+      _startTime(0),
+      _states(states),
       _brightness(15),
       _brightnessPrev(25),
       _direction(false),
-      _fillDownInit(false), _fillDownComplete(false),
-      _emptyDownInit(false), _emptyDownComplete(false),
-      _fillUpInit(false), _fillUpComplete(false),
       _tracker(0),
-      _prevHeatLevel(0),
       _repeat(true),
+      _sequence(nullptr),
 
       _lastBeatTime(0),
       _lastRandomUpdate(0), _isPeak(false),
-      _MIN_BASE_LEVEL(10), _MIN_PEAK_LEVEL(18), _randomOffset(0), _currentLevel(_MIN_BASE_LEVEL),
+      // Levels 10 and 18 on a 28 segments bar meter
+      _MIN_BASE_LEVEL(segNumber * 10 / 28), _MIN_PEAK_LEVEL(segNumber * 18 / 28), _randomOffset(0), _currentLevel(_MIN_BASE_LEVEL),
       _peakLevel(5), _prevPeakUpdate(0), _PEAK_HOLD_TIME(150),
       _speed(10), _corrSpeed(10),
       _update(true),
@@ -59,20 +59,12 @@ BarMeterAnimation::BarMeterAnimation(const uint8_t *segNumber)
 uint8_t BarMeterAnimation::getLedState(uint8_t index)
 {
     // If out of bound return 0
-    if (index >= *P_SEG_NUMBER || index < 0)
+    if (index >= _SEG_NUMBER)
     {
         return 0;
     }
-    // For the first 16 bits
-    if (index < 16)
-    {
-        return (_ledsStatesLow & (1 << index)) != 0;
-    }
-    // For the last 16 bits
-    else
-    {
-        return (_ledsStatesHigh & (1 << (index - 16))) != 0;
-    }
+
+    return (_states[index / BM_WORD_BITS] >> (index % BM_WORD_BITS)) & 0x01;
 }
 
 void BarMeterAnimation::clear()
@@ -87,232 +79,139 @@ void BarMeterAnimation::clear()
 
 void BarMeterAnimation::fillDownEmptyDownOnceInit(uint16_t duration, bool fadeIn) // fill from top to bottom and empty down to bottom
 {
-    _speed = max(5, duration) / (*P_SEG_NUMBER * 2);
+    _speed = max(5, duration) / (_SEG_NUMBER * 2);
     _speed = constrain(_speed, 10, 255);
 
     _fadeIn = fadeIn;
     _brightness = (_fadeIn == ENABLE) ? 0 : 15; // For the Fade In effect
-
-    _fillDownInit = true;
-    _fillDownComplete = false;
-    _emptyDownInit = false;
-    _emptyDownComplete = false;
+    _start();
 }
 
 void BarMeterAnimation::fillDownEmptyDownOnce() // fill from top to bottom and empty down to bottom
 {
-    if (_emptyDownComplete)
+    // Fill from the top for _SEG_NUMBER steps, then empty down for _SEG_NUMBER steps
+    uint16_t step = min(_stepsSinceStart(_speed), 2UL * _SEG_NUMBER);
+    if (!_newStep(step))
         return;
 
-    if (_fillDownInit)                                    // Initialise sequence
-        _fillDownInit = _fillDown(_speed, true, _fadeIn); // Initialize fill up
-
-    else if (!_fillDownComplete)
+    _setLow();
+    if (step <= _SEG_NUMBER)
     {
-        _fillDownComplete = _fillDown(_speed, false, _fadeIn); // Fill the bar meter upward
-        _emptyDownInit = _fillDownComplete;
+        _setRange(_SEG_NUMBER - step, _SEG_NUMBER, true);
+        if (_fadeIn)
+            _brightness = min(step / 2, 15); // Increase intensity one out of two steps
     }
-
-    else if (_emptyDownInit)
-        _emptyDownInit = _emptyDown(_speed, true, _fadeIn); // Initialize fill down
-
     else
-        _emptyDownComplete = _emptyDown(_speed, false, _fadeIn); // Empty the bar meter downward
+    {
+        uint16_t emptyStep = step - _SEG_NUMBER;
+        _setRange(0, _SEG_NUMBER - emptyStep, true);
+        if (_fadeIn)
+            _brightness = max(15 - (int16_t)(emptyStep / 2), 0); // Decrease intensity one out of two steps
+    }
 }
 
 void BarMeterAnimation::cyclotronIdleInit(uint8_t heatLevel)
 {
-    uint8_t scaledHeatLevel = constrain(map(heatLevel, 0, 100, 0, *P_SEG_NUMBER), 0, *P_SEG_NUMBER);
-
     _speed = 25;
-
-    _direction = false;
-    _tracker = scaledHeatLevel;
     _brightness = 15;
     _setLow();
+    _start();
 }
 
 void BarMeterAnimation::cyclotronIdle(uint8_t heatLevel)
 {
-    // Convert 0-100 scale to 0-*P_SEG_NUMBER (28)
-    uint8_t scaledHeatLevel = constrain(map(heatLevel, 0, 100, 0, *P_SEG_NUMBER), 0, *P_SEG_NUMBER);
+    // Convert 0-100 scale to 0-_SEG_NUMBER
+    uint8_t scaledHeatLevel = constrain(map(heatLevel, 0, 100, 0, _SEG_NUMBER), 0, _SEG_NUMBER);
 
-    if (_currentTime - _prevUpdate >= _speed)
-    {
-        _prevUpdate = _currentTime;
-        _update = true; // update required
-
-        for (uint8_t i = 0; i < *P_SEG_NUMBER; i++)
-        {
-            // Fill from bottom and top toward center up to tracker
-            if ((i < _tracker) || (i >= *P_SEG_NUMBER - _tracker))
-            {
-                _setLed(i, true);
-            }
-            else
-            {
-                _setLed(i, false);
-            }
-        }
-
-        // Increase tracker and reverse direction if center is reached
-        if (!_direction)
-        {
-            _tracker = min(_tracker + 1, 14);
-            if (_tracker >= 14)
-            {
-                _direction = true;
-            }
-        }
+    // Fill from bottom and top toward center up to tracker, bouncing between the heat level and the center
+    uint8_t tracker = _bounce(_stepsSinceStart(_speed), scaledHeatLevel / 2, _SEG_NUMBER / 2);
+    if (!_newStep(tracker))
+        return;
 
-        // Decrease tracker and reverse direction if heat Level is reached
-        else
-        {
-            _tracker = max(_tracker - 1, scaledHeatLevel / 2);
-            if (_tracker <= scaledHeatLevel / 2)
-            {
-                _direction = false;
-            }
-        }
-    }
+    _setLow();
+    _setRange(0, tracker, true);
+    _setRange(_SEG_NUMBER - tracker, _SEG_NUMBER, true);
 }
 
 void BarMeterAnimation::cyclotronIdleFullInit(uint8_t heatLevel)
 {
-    // // Convert 0-100 scale to 0-*P_SEG_NUMBER (28)
-    // uint8_t scaledHeatLevel = constrain(map(heatLevel, 0, 100, 0, *P_SEG_NUMBER - 5), 0, *P_SEG_NUMBER - 5);
-
     _speed = 10;
-    _prevHeatLevel = 0;
-
-    _direction = false; // Set initial direction to "up"
-    _tracker = 0;
     _brightness = 15;
-    _setLow(); // Fill the bar meter upwards initially
+    _setLow();
+    _start();
 }
 
 void BarMeterAnimation::cyclotronIdleFull(uint8_t heatLevel)
 {
-    if (_currentTime - _prevUpdate >= _speed)
-    {
-        // Convert 0-100 scale to 0-23, not 28, to leave a buffer for bouncing even at max heat level
-        uint8_t scaledHeatLevel = constrain(map(heatLevel, 0, 100, 0, *P_SEG_NUMBER - 5), 0, *P_SEG_NUMBER - 5);
-
-        // DEBUG_PRINTLN("Barmeter Idle Full : scaled HL = " + String(scaledHeatLevel) + "  tracker = " + String(_tracker));
-
-        // Fill the bottom relative to to heat level
-        if (_prevHeatLevel != heatLevel)
-        {
-            _prevHeatLevel = heatLevel;
-            _update = true; // update required
-            // for (uint8_t i = 0; i < scaledHeatLevel; i++)
-            // {
-            //     _setLed(i, true);
-            // }
-        }
+    // Convert 0-100 scale to 0-(_SEG_NUMBER - 5), to leave a buffer for bouncing even at max heat level
+    uint8_t scaledHeatLevel = constrain(map(heatLevel, 0, 100, 0, _SEG_NUMBER - 5), 0, _SEG_NUMBER - 5);
 
-        // Bounce from heat level to top
-        if (!_direction)
-        {
-            if (_tracker >= *P_SEG_NUMBER)
-            {
-                _tracker = *P_SEG_NUMBER - 1;
-                _direction = true;
-            }
-            else
-            {
-                _prevUpdate = _currentTime;
-                _update = true; // update required
-
-                // if (_tracker < *P_SEG_NUMBER && _tracker >= 0) // Bounds check
-                _setLed(_tracker, true);
-
-                _tracker++; // Move to the next LED
-            }
-        }
-        else
-        {
-            if (_tracker <= scaledHeatLevel)
-            {
-                _tracker = scaledHeatLevel;
-                _direction = false;
-            }
-            else
-            {
-                _prevUpdate = _currentTime;
-                _update = true; // update required
+    // Fill up once from empty, then bounce from the top down to the heat level
+    uint32_t step = _stepsSinceStart(_speed);
+    uint8_t tracker;
+    if (step < _SEG_NUMBER)
+        tracker = step;
+    else
+        tracker = _SEG_NUMBER - _bounce(step - _SEG_NUMBER, 0, _SEG_NUMBER - scaledHeatLevel);
 
-                // if (_tracker < *P_SEG_NUMBER && _tracker >= 0) // Bounds check
-                // {
-                _setLed(_tracker, false);
-                // }
+    if (!_newStep(tracker))
+        return;
 
-                _tracker--; // Move to the next LED
-            }
-        }
-    }
+    _setLow();
+    _setRange(0, tracker, true);
 }
 
 void BarMeterAnimation::fillUpEmptyDownOnceInit(uint16_t duration) // fill up from bottom to top and empty bottom to top
 {
-    _speed = max(5, duration) / (*P_SEG_NUMBER * 2);
+    _speed = max(5, duration) / (_SEG_NUMBER * 2);
     _speed = constrain(_speed, 10, 255);
 
-    _fillUpInit = true; // Set initial direction to "up"
-    _fillUpComplete = false;
-    _emptyDownInit = true; // Reset completed flag
-    _emptyDownComplete = false;
     _brightness = 15;
+    _start();
 }
 
 void BarMeterAnimation::fillUpEmptyDownOnce() // fill up from bottom to top and empty bottom to top
 {
-    if (_emptyDownComplete)
+    // Fill up for _SEG_NUMBER steps, then empty down for _SEG_NUMBER steps
+    uint16_t step = min(_stepsSinceStart(_speed), 2UL * _SEG_NUMBER);
+    if (!_newStep(step))
         return;
 
-    if (_fillUpInit)
-        _fillUpInit = _fillUp(_speed, true); // Initialise fill up
-
-    // Depending on the direction, either fill up or empty down
-    else if (!_fillUpComplete)
-        _fillUpComplete = _fillUp(_speed, false); // Fill up the bar meter
-
-    else if (_emptyDownInit)
-        _emptyDownInit = _emptyDown(_speed, true, DISABLE); // Empty down the bar meter
-
-    else
-        _emptyDownComplete = _emptyDown(_speed, false, DISABLE); // Empty down the bar meter
+    _setLow();
+    _setRange(0, (step <= _SEG_NUMBER) ? step : 2 * _SEG_NUMBER - step, true);
 }
 
 void BarMeterAnimation::fillUpFastEmptyDownSlowOnceInit(uint16_t duration, bool fadeout) // full bar fast and slow emptying from top to bottom
 {
     _fadeOut = fadeout;
-    _speed = round(max(5, duration - 10.0 * *P_SEG_NUMBER) / (*P_SEG_NUMBER * 1.1));
+    _speed = round(max(5, duration - 10.0 * _SEG_NUMBER) / (_SEG_NUMBER * 1.1));
     _speed = constrain(_speed, 10, 255);
 
-    _fillUpInit = true; // Set initial direction to "up"
-    _fillUpComplete = false;
-    _emptyDownInit = true; // Reset completed flag
-    _emptyDownComplete = false;
     _brightness = 15;
+    _start();
 }
 
 void BarMeterAnimation::fillUpFastEmptyDownSlowOnce() // full bar fast and slow emptying from top to bottom
 {
-    if (_emptyDownComplete)
+    // Fill up at 10ms per step, then empty down at _speed per step
+    uint32_t fillTime = 10UL * _SEG_NUMBER;
+    uint32_t elapsed = _currentTime - _startTime;
+    uint16_t step = (elapsed < fillTime) ? elapsed / 10 : _SEG_NUMBER + min((elapsed - fillTime) / _speed, (uint32_t)_SEG_NUMBER);
+    if (!_newStep(step))
         return;
 
-    if (_fillUpInit)
-        _fillUpInit = _fillUp(10, true);
-
-    else if (!_fillUpComplete)
-        _fillUpComplete = _fillUp(10, false); // Fill up the bar meter
-
-    else if (_emptyDownInit)
-        _emptyDownInit = _emptyDown(_speed, true, _fadeOut);
-
+    _setLow();
+    if (step <= _SEG_NUMBER)
+    {
+        _setRange(0, step, true);
+    }
     else
-        _emptyDownComplete = _emptyDown(_speed, false, _fadeOut);
+    {
+        uint16_t emptyStep = step - _SEG_NUMBER;
+        _setRange(0, _SEG_NUMBER - emptyStep, true);
+        if (_fadeOut)
+            _brightness = max(15 - (int16_t)(emptyStep / 2), 0); // Decrease intensity one out of two steps
+    }
 }
 
 void BarMeterAnimation::partyModeInit() // bouncing from bottom (maybe like a volume meter with the music)
@@ -337,26 +236,23 @@ void BarMeterAnimation::partyMode() // bouncing from bottom (maybe like a volume
     // Smooth transition between base and peak levels
     if (_isPeak && _currentLevel <= _MIN_PEAK_LEVEL)
     {
-        _currentLevel += random(3, 5); // Gradual increase
+        _currentLevel += FastRandom::range(3, 5); // Gradual increase
     }
     else if (!_isPeak && _currentLevel >= _MIN_BASE_LEVEL)
     {
-        _currentLevel -= random(0, 4); // Gradual decrease
+        _currentLevel -= FastRandom::range(0, 4); // Gradual decrease
     }
 
     // Randomized additional LEDs on top at a random interval
-    if (_currentTime - _lastRandomUpdate >= uint16_t(random(50, 300)))
+    if (_currentTime - _lastRandomUpdate >= uint16_t(FastRandom::range(50, 300)))
     {
         _lastRandomUpdate = _currentTime;
         _update = true;                // update required
-        _randomOffset = random(-4, 4); // 0 to 5 extra LEDs
+        _randomOffset = FastRandom::range(-4, 4); // 0 to 5 extra LEDs
     }
 
-    uint8_t finalLevel = _currentLevel + _randomOffset;
-    if (finalLevel > *P_SEG_NUMBER)
-        finalLevel = *P_SEG_NUMBER;
-    if (finalLevel < 0)
-        finalLevel = 0;
+    int16_t level = _currentLevel + (int8_t)_randomOffset;
+    uint8_t finalLevel = constrain(level, 0, _SEG_NUMBER);
 
     // Update peak level
     if (finalLevel > _peakLevel)
@@ -372,42 +268,44 @@ void BarMeterAnimation::partyMode() // bouncing from bottom (maybe like a volume
     }
 
     // Update LED states
-    for (uint8_t i = 0; i < *P_SEG_NUMBER; i++)
-    {
-        _setLed(i, (i < finalLevel));
-    }
+    _setRange(0, finalLevel, true);
+    _setRange(finalLevel, _SEG_NUMBER, false);
 
     // Ensure peak LED stays on
-    if (_peakLevel < *P_SEG_NUMBER)
+    if (_peakLevel < _SEG_NUMBER)
     {
         _setLed(_peakLevel, true);
     }
 }
 
-bool fire1[23][28] = {
-    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0},
-    {0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0},
-    {0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0},
-    {0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0},
-    {0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0},
-    {0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0},
-    {0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0},
-    {0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0},
-    {1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1},
-    {1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1},
-    {1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1},
-    {1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1},
-    {1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1},
-    {1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1},
-    {1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1},
-    {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
-    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
+// Fire animation frames drawn for 28 segments, segment #1 is bit 0
+const uint32_t FIRE_FRAMES[] PROGMEM = {
+    0x00000000, // Frame #0
+    0x00006000, // Frame #1
+    0x0000F000, // Frame #2
+    0x0001F800, // Frame #3
+    0x0003FC00, // Frame #4
+    0x0007FE00, // Frame #5
+    0x000FFF00, // Frame #6
+    0x001FFF80, // Frame #7
+    0x003FFFC0, // Frame #8
+    0x007F9FE0, // Frame #9
+    0x00FF0FF0, // Frame #10
+    0x01FE07F8, // Frame #11
+    0x03FC03FC, // Frame #12
+    0x07F801FE, // Frame #13
+    0x0FF000FF, // Frame #14
+    0x0FE0007F, // Frame #15
+    0x0FC0003F, // Frame #16
+    0x0F80001F, // Frame #17
+    0x0F00000F, // Frame #18
+    0x0E000007, // Frame #19
+    0x0C000003, // Frame #20
+    0x08000001, // Frame #21
+    0x00000000  // Frame #22
+};
+
+const BarMeterFrameSequence FIRE_SEQUENCE = {FIRE_FRAMES, sizeof(FIRE_FRAMES) / sizeof(FIRE_FRAMES[0]), 28};
 
 void BarMeterAnimation::fireInit(bool direction)
 {
@@ -416,19 +314,18 @@ void BarMeterAnimation::fireInit(bool direction)
 
 void BarMeterAnimation::fireInit(bool direction, bool repeat)
 {
-    _direction = direction;
-    _repeat = repeat;
+    // Capture plays the sequence from the last frame, Burst from the first frame
+    // If the previous state sequence must just be finished in this state, there is no restart
+    _brightness = 15;
+    _sequenceSet(&FIRE_SEQUENCE, direction == CAPTURE, repeat, repeat == REPEAT_SEQ);
 
-    // If the previous tate sequence must just be finished in this state
-    if (_repeat == END_SEQ)
+    if (repeat == END_SEQ)
         return;
 
     // Initialize if it's not just the ending sequence
     _speed = 25;
-    _tracker = _direction ? 0 : 22; // Capture starts from the last frame, Burst starts from the first frame
     _corrSpeed = _speed;
     _brightness = 15;
-    _setLow();
 }
 
 void BarMeterAnimation::fire(uint8_t heatLevel)
@@ -436,38 +333,19 @@ void BarMeterAnimation::fire(uint8_t heatLevel)
     // Get the corrected speed from heat level
     _corrSpeed = map(heatLevel, 0, 100, _speed, 10);
 
-    // Check if enough time has passed to update the animation
-    if (_currentTime - _prevUpdate >= _corrSpeed)
-    {
-        // DEBUG_PRINTLN("_direction:" + String(_direction) + " _repeat:" + String(_repeat) + " _tracker:" + String(_tracker));
-
-        _prevUpdate = _currentTime;
-        _update = true; // update required
+    _sequenceStep(_corrSpeed);
+}
 
-        // Update LED states based on the current frame in fire1
-        for (int8_t i = 0; i < *P_SEG_NUMBER; i++)
-        {
-            _setLed(i, fire1[_tracker][i]);
-        }
+void BarMeterAnimation::sequenceInit(const BarMeterFrameSequence &sequence, uint8_t speed, bool reverse, bool repeat)
+{
+    _speed = speed;
+    _brightness = 15;
+    _sequenceSet(&sequence, reverse, repeat, true);
+}
 
-        // Move to the previous frame
-        if (_direction == CAPTURE)
-        {
-            // Move to the next frame in the selected direction
-            _tracker--;
-            // Repeat or end sequence
-            if (_tracker < 0)
-                _tracker = (_repeat == REPEAT_SEQ) ? 22 : 0;
-        }
-        else
-        {
-            // Move to the next frame in the selected direction
-            _tracker++;
-            // Repeat or end sequence
-            if (_tracker > 22)
-                _tracker = (_repeat == REPEAT_SEQ) ? 0 : 22;
-        }
-    }
+bool BarMeterAnimation::sequence()
+{
+    return _sequenceStep(_speed);
 }
 
 /*void BarMeterAnimation::bouncingFromBottom(bool initialize)
@@ -513,9 +391,9 @@ void BarMeterAnimation::fire(uint8_t heatLevel)
         _prevUpdate = _currentTime;
         _update = true; // update required
 
-        for (uint8_t i = 0; i < *P_SEG_NUMBER; i++)
+        for (uint8_t i = 0; i < _SEG_NUMBER; i++)
         {
-            if ((i < tracker) || (i >= *P_SEG_NUMBER - tracker))
+            if ((i < tracker) || (i >= _SEG_NUMBER - tracker))
             {
                 _setLed(i, false);
             }
@@ -561,7 +439,7 @@ void BarMeterAnimation::fire(uint8_t heatLevel)
         _prevUpdate = _currentTime;
         _update = true; // update required
 
-        for (uint8_t i = 0; i < *P_SEG_NUMBER; i++)
+        for (uint8_t i = 0; i < _SEG_NUMBER; i++)
         {
             if (i > 14 - level && i < 13 + level)
             {
@@ -574,7 +452,7 @@ void BarMeterAnimation::fire(uint8_t heatLevel)
         }
 
         _setLed(tracker, true);
-        _setLed(*P_SEG_NUMBER - 1 - tracker, true);
+        _setLed(_SEG_NUMBER - 1 - tracker, true);
         tracker--;
         if (tracker < 0)
         {
@@ -595,7 +473,7 @@ void BarMeterAnimation::fire(uint8_t heatLevel)
         _prevUpdate = _currentTime;
         _update = true; // update required
 
-        for (int8_t i = 0; i < *P_SEG_NUMBER; i++)
+        for (int8_t i = 0; i < _SEG_NUMBER; i++)
         {
             // Only segement equal to running led tracker will be ON
             if (i == _tracker - 1)
@@ -610,9 +488,9 @@ void BarMeterAnimation::fire(uint8_t heatLevel)
         if (_reverseSeqTracker == false)
         {
             _tracker++;
-            if (_tracker >= *P_SEG_NUMBER)
+            if (_tracker >= _SEG_NUMBER)
             {
-                _tracker = *P_SEG_NUMBER;
+                _tracker = _SEG_NUMBER;
                 _reverseSeqTracker = true;
             }
         }
@@ -629,198 +507,217 @@ void BarMeterAnimation::fire(uint8_t heatLevel)
 }*/
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/*     Private short sequences use in Animations         */ /////////////////////////////////////////////////
-/*        (this functions call for an update)            */ /////////////////////////////////////////////////
+/*     Private helpers use in Animations                 */ /////////////////////////////////////////////////
+/*  Animations frames are computed from the elapsed time */ /////////////////////////////////////////////////
+/*  since init, a stalled loop jumps to the right frame  */ /////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-bool BarMeterAnimation::_fillUp(uint8_t speed, bool initialize)
+void BarMeterAnimation::_start()
 {
-    if (initialize)
-    {
-        _tracker = 0;
-        _setLow();
-        _update = true; // update required
-    }
+    _startTime = _currentTime;
+    _tracker = -1; // No step rendered yet
+}
 
-    if (_tracker > *P_SEG_NUMBER)
-    {
-        _tracker = *P_SEG_NUMBER;
-        return true;
-    }
+uint32_t BarMeterAnimation::_stepsSinceStart(uint8_t speed) const
+{
+    return (_currentTime - _startTime) / speed;
+}
 
-    if (_currentTime - _prevUpdate >= speed)
-    {
-        _prevUpdate = _currentTime;
-        _update = true; // update required
+bool BarMeterAnimation::_newStep(int16_t step)
+{
+    // Same step as the last rendered one, nothing to do
+    if (step == _tracker)
+        return false;
 
-        if (_tracker < *P_SEG_NUMBER && _tracker >= 0) // Bounds check
-            _setLed(_tracker, true);
+    _tracker = step;
+    _update = true; // update required
+    return true;
+}
 
-        _tracker++; // Move to the next LED
-    }
+uint8_t BarMeterAnimation::_bounce(uint32_t step, uint8_t low, uint8_t high)
+{
+    // Triangle wave : up from low to high and back down, one segment per step
+    if (low >= high)
+        return high;
 
-    return false;
+    uint8_t span = high - low;
+    uint16_t phase = step % (2 * span);
+    return low + ((phase <= span) ? phase : 2 * span - phase);
 }
 
-bool BarMeterAnimation::_emptyDown(uint8_t speed, bool initialize, bool fadeout)
+void BarMeterAnimation::_sequenceSet(const BarMeterFrameSequence *sequence, bool reverse, bool repeat, bool restart)
 {
-    static bool intensityFlag = false;
+    _sequence = sequence;
+    _direction = reverse;
+    _repeat = repeat;
 
-    if (initialize)
+    if (restart)
     {
-        _tracker = *P_SEG_NUMBER;
-        _setHigh();
+        // Show the first frame right away
+        _tracker = reverse ? _sequence->frameCount - 1 : 0;
+        _prevUpdate = _currentTime;
+        _setFrame(pgm_read_dword(&_sequence->frames[_tracker]), _sequence->width);
         _update = true; // update required
     }
+}
 
-    if (_tracker < 0)
-    {
-        _tracker = 0;
+bool BarMeterAnimation::_sequenceStep(uint8_t speed)
+{
+    if (_sequence == nullptr)
         return true;
-    }
 
-    if (_currentTime - _prevUpdate >= speed)
-    {
-        _prevUpdate = _currentTime;
-        _update = true; // update required
+    // Frames due since the last one : more than one if the loop stalled.
+    // The speed follows the heat level, so the time not used by a whole frame is carried over.
+    uint32_t steps = (_currentTime - _prevUpdate) / speed;
+    if (steps == 0)
+        return false;
 
-        if (_tracker < *P_SEG_NUMBER && _tracker >= 0) // Bounds check
-        {
-            _setLed(_tracker, false);
-        }
+    _prevUpdate += steps * speed;
 
-        _tracker--; // Move to the next LED
+    // Move in the selected direction, then repeat or hold the last frame
+    int16_t last = _sequence->frameCount - 1;
+    int16_t position = _direction ? last - _tracker : _tracker; // Position from the start of the sequence
+    bool done = false;
+    if (_repeat == REPEAT_SEQ)
+    {
+        position = (position + steps) % _sequence->frameCount;
+    }
+    else if (position + steps >= (uint32_t)last)
+    {
+        done = position == last;
+        position = last;
+    }
+    else
+    {
+        position += steps;
+    }
 
-        if (fadeout)
-        {
-            if (intensityFlag)
-            {
-                _brightness = (max(0, _brightness - 1));
-            }
+    _tracker = _direction ? last - position : position;
 
-            intensityFlag = !intensityFlag; // Decrease intensity only one out of two update
-        }
-    }
+    // Update LED states with the current frame read from flash
+    _setFrame(pgm_read_dword(&_sequence->frames[_tracker]), _sequence->width);
+    _update = true; // update required
 
-    return false;
+    return done;
 }
 
-bool BarMeterAnimation::_fillDown(uint8_t speed, bool initialize, bool fadein)
+void BarMeterAnimation::_setFrame(uint32_t frame, uint8_t width)
 {
-    static bool intensityFlag = false;
-
-    if (initialize)
+    // Frame drawn for this bar meter length : straight word copy, only keeping the existing segments
+    if (width == _SEG_NUMBER)
     {
-        _tracker = *P_SEG_NUMBER;
-        _setLow();
-        _update = true; // update required
+        _states[0] = (_SEG_NUMBER < BM_WORD_BITS) ? frame & ((1UL << _SEG_NUMBER) - 1) : frame;
+        return;
     }
 
-    if (_tracker < 0)
+    // Otherwise each segment takes the state of its relative position in the frame
+    for (uint8_t w = 0; w < _STATE_WORDS; w++)
+        _states[w] = 0;
+
+    for (uint8_t i = 0; i < _SEG_NUMBER; i++)
     {
-        _tracker = 0;
-        return true;
+        uint8_t bit = (uint16_t)i * width / _SEG_NUMBER;
+        if ((frame >> bit) & 0x01)
+            _states[i / BM_WORD_BITS] |= 1UL << (i % BM_WORD_BITS);
     }
+}
 
-    if (_currentTime - _prevUpdate >= speed)
+// Segments are added in logical order : the segment extends the last run when it lands on the next row bit,
+// up or down, otherwise it starts a new run
+void BarMeterAnimation::_addToRuns(BarMeterRun *runs, uint8_t &runCount, uint8_t segment, uint8_t row, uint8_t bit)
+{
+    if (runCount > 0 && segment % BM_WORD_BITS != 0)
     {
-        _prevUpdate = _currentTime;
-        _update = true; // update required
+        BarMeterRun &run = runs[runCount - 1];
+        uint8_t length = run.length & ~BM_RUN_REVERSED;
+        bool reversed = run.length & BM_RUN_REVERSED;
 
-        if (_tracker < *P_SEG_NUMBER && _tracker >= 0) // Bounds check
+        if (run.row == row && !reversed && bit == run.shift + length)
         {
-            _setLed(_tracker, true);
+            run.length = length + 1;
+            return;
         }
-
-        _tracker--; // Move to the next LED
-
-        if (fadein)
+        if (run.row == row && (reversed || length == 1) && bit + 1 == run.shift)
         {
-            if (intensityFlag)
-            {
-                _brightness = (min(_brightness + 1, 15));
-            }
-
-            intensityFlag = !intensityFlag; // Increase intensity only one out of two update
+            run.shift = bit;
+            run.length = (length + 1) | BM_RUN_REVERSED;
+            return;
         }
     }
-
-    return false;
+    runs[runCount++] = {segment, row, bit, 1};
 }
 
-bool BarMeterAnimation::_emptyUp(uint8_t speed, bool initialize)
-{
-    if (initialize)
-    {
-        _tracker = 0;
-        _setHigh();
-        _update = true; // update required
-    }
+// Bits order reversed in each nibble
+static const uint8_t NIBBLE_REVERSE[16] = {0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE, 0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF};
 
-    if (_tracker > *P_SEG_NUMBER)
-    {
-        _tracker = *P_SEG_NUMBER;
-        return true;
-    }
+// Run states aligned on the run lowest row bit
+uint16_t BarMeterAnimation::_runBits(const BarMeterRun &run) const
+{
+    uint8_t length = run.length & ~BM_RUN_REVERSED;
+    uint16_t bits = (_states[run.first / BM_WORD_BITS] >> (run.first % BM_WORD_BITS)) & ((1UL << length) - 1);
 
-    if (_currentTime - _prevUpdate >= speed)
+    if (bits && (run.length & BM_RUN_REVERSED))
     {
-        _prevUpdate = _currentTime;
-        _update = true; // update required
-
-        if (_tracker < *P_SEG_NUMBER && _tracker >= 0) // Bounds check
-        {
-            _setLed(_tracker, false);
-        }
-
-        _tracker++; // Move to the next LED
+        // Mirror the 16 bits, then shift the run back down to bit 0
+        bits = (NIBBLE_REVERSE[bits & 0x0F] << 12) | (NIBBLE_REVERSE[(bits >> 4) & 0x0F] << 8) |
+               (NIBBLE_REVERSE[(bits >> 8) & 0x0F] << 4) | NIBBLE_REVERSE[bits >> 12];
+        bits >>= 16 - length;
     }
-
-    return false;
+    return bits;
 }
 
 void BarMeterAnimation::_setHigh()
 {
     _update = true; // update required
 
-    // Set all 32 bits to 1, turning all LEDs on
-    _ledsStatesLow = 0xFFFF;
-    _ledsStatesHigh = 0xFFFF;
+    // Turn all existing LEDs on, bits past the last segment stay low
+    _setRange(0, _SEG_NUMBER, true);
 }
 
 void BarMeterAnimation::_setLow()
 {
     _update = true; // update required
 
-    // Set all 32 bits to 0, turning all LEDs off
-    _ledsStatesLow = 0;
-    _ledsStatesHigh = 0;
+    // Turn all LEDs off
+    for (uint8_t w = 0; w < _STATE_WORDS; w++)
+        _states[w] = 0;
 }
 
 void BarMeterAnimation::_setLed(uint8_t index, bool state)
 {
-    if (index < 16 && index >= 0)
-    {
-        if (state)
-        {
-            _ledsStatesLow |= (1 << index); // Set the LED in the lower part (0-15)
-        }
-        else
-        {
-            _ledsStatesLow &= ~(1 << index); // Clear the LED in the lower part (0-15)
-        }
-    }
-    else if (index < 28)
+    if (index >= _SEG_NUMBER)
+        return;
+
+    uint32_t mask = 1UL << (index % BM_WORD_BITS);
+    if (state)
+        _states[index / BM_WORD_BITS] |= mask;
+    else
+        _states[index / BM_WORD_BITS] &= ~mask;
+}
+
+void BarMeterAnimation::_setRange(uint8_t from, uint8_t to, bool state)
+{
+    // Segments from "from" up to "to" excluded, clipped to the existing segments
+    if (to > _SEG_NUMBER)
+        to = _SEG_NUMBER;
+    if (from >= to)
+        return;
+
+    // One mask operation per word touched by the range
+    uint8_t first = from / BM_WORD_BITS;
+    uint8_t last = (to - 1) / BM_WORD_BITS;
+    for (uint8_t w = first; w <= last; w++)
     {
-        uint8_t shiftedIndex = index - 16;
+        uint32_t mask = 0xFFFFFFFF;
+        if (w == first)
+            mask &= 0xFFFFFFFFUL << (from % BM_WORD_BITS);
+        if (w == last)
+            mask &= 0xFFFFFFFFUL >> (BM_WORD_BITS - 1 - (to - 1) % BM_WORD_BITS);
+
         if (state)
-        {
-            _ledsStatesHigh |= (1 << shiftedIndex); // Set the LED in the upper part (16-27)
-        }
+            _states[w] |= mask;
         else
-        {
-            _ledsStatesHigh &= ~(1 << shiftedIndex); // Clear the LED in the upper part (16-27)
-        }
+            _states[w] &= ~mask;
     }
 }
 
@@ -828,31 +725,47 @@ void BarMeterAnimation::_setLed(uint8_t index, bool state)
 /*                         HT16K33 Driver class definitions and functions                                    */
 /*************************************************************************************************************/
 
-HT16K33Driver::HT16K33Driver(const uint8_t *segNumber,
+HT16K33Driver::HT16K33Driver(uint8_t segNumber, uint32_t *states, BarMeterRun *runs,
                              const bool *direction,
                              const uint8_t dataPin, const uint8_t clockPin,
                              const uint8_t address,
-                             const uint8_t (*mapping)[2])
-    : BarMeterAnimation(segNumber),
+                             const uint8_t (*mapping)[2],
+                             uint32_t busClock,
+                             bool async)
+    : BarMeterAnimation(segNumber, states),
       P_DIRECTION(direction),
       _CLOCK_PIN(clockPin), _DATA_PIN(dataPin), _ADDRESS(address),
-      BM_SEG_MAP(mapping)
+      _BUS_CLOCK(busClock), _ASYNC(async),
+      BM_SEG_MAP(mapping),
+      _runs(runs), _runCount(0),
+      _rows{0},
+      _frameBytes(0)
 {
 }
 
 void HT16K33Driver::begin()
 {
-    _driver.init(_ADDRESS);
+    _buildLookup();
+    _driver.init(_ADDRESS, _BUS_CLOCK);
     _driver.setBrightness(_brightness); // Set maxBri level (0 is min, 15 is max)
     _driver.clear();
+    _driver.setAsync(_ASYNC);
     clear();
     DEBUG_PRINTLN("HT16K33 bar meter driver DEBUG ON");
 }
 
 void HT16K33Driver::update()
 {
-    // Update only if required
-    if (_update)
+    update(millis());
+}
+
+void HT16K33Driver::update(uint32_t syncCurrentTime)
+{
+    _currentTime = syncCurrentTime;
+
+    // Update only if required, and once the previous frame flush is complete :
+    // while it is in flight, the changes coalesce into the next frame instead of queuing behind it
+    if (_update && !_driver.isBusy())
     {
         // Reset update required tracker
         _update = false;
@@ -863,45 +776,85 @@ void HT16K33Driver::update()
             _brightnessPrev = _brightness;
             _driver.setBrightness(_brightness); // Set maxBri level (0 is min, 15 is max)
         }
-        // To be configure for in relation with bar meter total leds number and connections matrix to the MAX72xx
-        // Leds mapping might be different for your setup, check rows and columns orders : _driver.setPixel(0, ROW, COL, _ledsStates[i]))
-        for (uint8_t i = 0; i < *P_SEG_NUMBER; i++)
-        {
-            // Check if animation is REVERSED
-            uint8_t j = *P_DIRECTION ? (*P_SEG_NUMBER - 1 - i) : i; // DIRECTION : false = forward, true = reverse
+        // Compose the whole frame in RAM from the lookup table, then only send the bytes range that changed
+        _composeRows();
+        for (uint8_t row = 0; row < 8; row++)
+            _driver.setRow(row, _rows[row]);
 
-            // set segments according to mapping define in setting
-            _driver.setPixel(BM_SEG_MAP[j][0], BM_SEG_MAP[j][1], getLedState(i));
-        }
         _driver.write();
+
+        _frameBytes = _driver.getLastWriteSize();
+    }
+}
+
+uint8_t HT16K33Driver::getFrameBytes() const { return _frameBytes; }
+
+void HT16K33Driver::_buildLookup()
+{
+    // To be configure for in relation with bar meter total leds number and connections matrix to the HT16K33
+    // Leds mapping might be different for your setup, check rows and columns orders : BM_SEG_MAP[i] = {COL, ROW}
+    _runCount = 0;
+    for (uint8_t i = 0; i < _SEG_NUMBER; i++)
+    {
+        // Check if animation is REVERSED
+        uint8_t j = *P_DIRECTION ? (_SEG_NUMBER - 1 - i) : i; // DIRECTION : false = forward, true = reverse
+
+        _addToRuns(_runs, _runCount, i, BM_SEG_MAP[j][1] & 0x07, BM_SEG_MAP[j][0] & 0x0F);
     }
 }
 
+void HT16K33Driver::_composeRows()
+{
+    memset(_rows, 0, sizeof(_rows));
+
+    // One mask and shift per run, the stock mappings have a single run per row
+    for (uint8_t i = 0; i < _runCount; i++)
+        _rows[_runs[i].row] |= _runBits(_runs[i]) << _runs[i].shift;
+}
+
 /*************************************************************************************************************/
 /*                         MAX72xx Driver class definitions and functions                                    */
 /*************************************************************************************************************/
 
-MAX72xxDriver::MAX72xxDriver(const uint8_t *segNumber,
+MAX72xxDriver::MAX72xxDriver(uint8_t segNumber, uint32_t *states, BarMeterRun *runs, uint8_t *rows, uint8_t numDevices,
                              const bool *direction,
                              const uint8_t dataPin, const uint8_t clockPin, const uint8_t loadPin,
-                             const uint8_t (*mapping)[2])
-    : BarMeterAnimation(segNumber),
+                             const uint8_t (*mapping)[2],
+                             MAX72xxTransport transport)
+    : BarMeterAnimation(segNumber, states),
       P_DIRECTION(direction),
       _DATA_PIN(dataPin), _CLOCK_PIN(clockPin), _LOAD_PIN(loadPin),
-      _driver(MAX72xx(_DATA_PIN, _CLOCK_PIN, _LOAD_PIN, 1)),
-      BM_SEG_MAP(mapping)
+      _TRANSPORT(transport),
+      _NUM_DEVICES(numDevices),
+      _driver(MAX72xx(_DATA_PIN, _CLOCK_PIN, _LOAD_PIN, _NUM_DEVICES, _TRANSPORT)),
+      BM_SEG_MAP(mapping),
+      _runs(runs), _runCount(0),
+      _rows(rows),
+      _frameTransfers(0)
 {
 }
 
 void MAX72xxDriver::begin()
 {
+    _buildLookup();
     pinMode(_LOAD_PIN, OUTPUT);
     pinMode(_CLOCK_PIN, OUTPUT);
     pinMode(_DATA_PIN, OUTPUT);
-    _driver.setScanLimit(0, 6);
-    _driver.shutdown(0, false);
-    _driver.setIntensity(0, _brightness); // Set maxBri level (0 is min, 15 is max)
-    _driver.clearDisplay(0);
+    _driver.begin();
+    // The bar meter device only scans up to the highest digit row used by the mapping
+    uint8_t scanLimit = 0;
+    for (uint8_t i = 0; i < _runCount; i++)
+        scanLimit = max(scanLimit, _runs[i].row);
+    _driver.setScanLimit(0, scanLimit);
+    for (uint8_t device = 0; device < _NUM_DEVICES; device++)
+    {
+        // Additional displays use all 8 digits rows
+        if (device > 0)
+            _driver.setScanLimit(device, 7);
+        _driver.shutdown(device, false);
+        _driver.setIntensity(device, _brightness); // Set maxBri level (0 is min, 15 is max)
+        _driver.clearDisplay(device);
+    }
     clear();
     DEBUG_PRINTLN("MAX72xx bar meter driver DEBUG ON");
 }
@@ -913,7 +866,7 @@ void MAX72xxDriver::update()
 
 void MAX72xxDriver::update(uint32_t syncCurrentTime)
 {
-_currentTime = syncCurrentTime;
+    _currentTime = syncCurrentTime;
 
     // Update only if required
     if (_update)
@@ -921,6 +874,8 @@ _currentTime = syncCurrentTime;
         // Reset update required tracker
         _update = false;
 
+        _driver.resetTransferCount();
+
         // Update brightness id needed
         if (_brightness != _brightnessPrev)
         {
@@ -928,15 +883,74 @@ _currentTime = syncCurrentTime;
             _driver.setIntensity(0, _brightness); // Set maxBri level (0 is min, 15 is max)
         }
 
-        // To be configure for in relation with bar meter total leds number and connections matrix to the MAX72xx
-        // Leds mapping might be different for your setup, check rows and columns orders : _driver.setLed(0, ROW, COL, _ledsStates[i]))
-        for (uint8_t i = 0; i < *P_SEG_NUMBER; i++)
-        {
-            // Check if animation is REVERSED
-            uint8_t j = *P_DIRECTION ? (*P_SEG_NUMBER - 1 - i) : i; // DIRECTION : false = forward, true = reverse
+        // Compose the whole frame in RAM, then only send the rows that changed since last frame,
+        // one latch per row for the whole chain
+        _composeRows();
+        _driver.updateChain(_rows);
+
+        _frameTransfers = _driver.getTransferCount();
+    }
+}
+
+void MAX72xxDriver::setDisplayRow(uint8_t device, uint8_t row, uint8_t value)
+{
+    // Additional displays only, device 0 rows are composed from the bar meter states
+    if (device == 0 || device >= _NUM_DEVICES || row > 7)
+        return;
+
+    if (_rows[device * 8 + row] != value)
+    {
+        _rows[device * 8 + row] = value;
+        _update = true; // update required
+    }
+}
 
-            // set segments according to mapping define in setting
-            _driver.setLed(0, BM_SEG_MAP[j][0], BM_SEG_MAP[j][1], getLedState(i));
+uint8_t MAX72xxDriver::getFrameTransfers() const { return _frameTransfers; }
+
+void MAX72xxDriver::benchmark(Stream &out, uint16_t iterations)
+{
+    const MAX72xxTransport TRANSPORTS[] = {MAX72xx_BITBANG, MAX72xx_FAST_GPIO, MAX72xx_HW_SPI};
+    const char *NAMES[] = {"BITBANG", "FAST_GPIO", "HW_SPI"};
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        out.print("MAX72xx ");
+        out.print(NAMES[i]);
+        if (_driver.setTransport(TRANSPORTS[i]) != TRANSPORTS[i])
+        {
+            out.println(" : not available on these pins");
+            continue;
         }
+        out.print(" : ");
+        out.print(_driver.benchmarkRowWrite(0, iterations));
+        out.println(" us per row write");
+    }
+
+    // Back to the configured transport
+    _driver.setTransport(_TRANSPORT);
+}
+
+void MAX72xxDriver::_buildLookup()
+{
+    // To be configure for in relation with bar meter total leds number and connections matrix to the MAX72xx
+    // Leds mapping might be different for your setup, check rows and columns orders : BM_SEG_MAP[i] = {ROW, COL}
+    _runCount = 0;
+    for (uint8_t i = 0; i < _SEG_NUMBER; i++)
+    {
+        // Check if animation is REVERSED
+        uint8_t j = *P_DIRECTION ? (_SEG_NUMBER - 1 - i) : i; // DIRECTION : false = forward, true = reverse
+
+        // Column 0 is the row most significant bit
+        _addToRuns(_runs, _runCount, i, BM_SEG_MAP[j][0] & 0x07, 7 - (BM_SEG_MAP[j][1] & 0x07));
     }
 }
+
+void MAX72xxDriver::_composeRows()
+{
+    // Only the bar meter device rows
+    memset(_rows, 0, 8);
+
+    // One mask and shift per run, the stock mappings have a single run per row
+    for (uint8_t i = 0; i < _runCount; i++)
+        _rows[_runs[i].row] |= _runBits(_runs[i]) << _runs[i].shift;
+}
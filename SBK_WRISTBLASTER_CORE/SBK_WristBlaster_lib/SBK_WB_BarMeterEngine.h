@@ -19,8 +19,8 @@
 
 #include <Arduino.h>
 #include "SBK_WB_MAX72xx.h"
-#include <SPI.h>
 #include "SBK_WB_HT16K33.h"
+#include "SBK_WB_Random.h"
 
 /* GENERAL HELPERS */
 #ifndef DISABLE
@@ -43,6 +43,11 @@
 #ifndef BURST
 #define BURST 1
 #endif
+// Bar meter states storage : one bit per segment, packed in 32 bits words (segment #1 is bit 0 of word 0)
+#ifndef BM_WORD_BITS
+#define BM_WORD_BITS 32
+#endif
+#define BM_STATE_WORDS(segments) (((segments) + BM_WORD_BITS - 1) / BM_WORD_BITS)
 // animation directions
 #ifndef FORWARD
 #define FORWARD 0
@@ -51,10 +56,30 @@
 #define REVERSE 1
 #endif
 
+// Bar meter frame sequence : frames are packed as 32 bits masks (segment #1 is bit 0) stored in flash (PROGMEM)
+// Frames drawn for a given segments number (width) are stretched or shrunk to the actual bar meter length
+struct BarMeterFrameSequence
+{
+    const uint32_t *frames;
+    uint8_t frameCount;
+    uint8_t width;
+};
+
+// Run of consecutive logical segments lit on consecutive bits of one driver row : a frame composes it with a
+// single mask and shift instead of one lookup per segment
+struct BarMeterRun
+{
+    uint8_t first;  // First logical segment, a run never crosses a states word
+    uint8_t row;    // Driver row
+    uint8_t shift;  // Lowest row bit of the run
+    uint8_t length; // Segments in the run, BM_RUN_REVERSED set when the row bits go down along the segments
+};
+#define BM_RUN_REVERSED 0x80
+
 class BarMeterAnimation
 {
 public:
-    BarMeterAnimation(const uint8_t *segNumber);
+    BarMeterAnimation(uint8_t segNumber, uint32_t *states);
     uint8_t getLedState(uint8_t index);
     void clear();
     void partyModeInit();
@@ -77,29 +102,29 @@ public:
     void fireInit(bool direction, bool repeat);
     void fire(uint8_t heatLevel);
     void fire(uint8_t heatLevel, bool repeat);
+    void sequenceInit(const BarMeterFrameSequence &sequence, uint8_t speed, bool reverse, bool repeat);
+    bool sequence();
 
 protected:
-    const uint8_t *P_SEG_NUMBER;
+    const uint8_t _SEG_NUMBER;
+    const uint8_t _STATE_WORDS;
     uint32_t _currentTime;
     uint32_t _prevUpdate;
-    uint16_t _ledsStatesLow;  // Stores the state for LEDs 0-15
-    uint16_t _ledsStatesHigh; // Stores the state for LEDs 16-27
+    uint32_t _startTime; // Animation init time, frames are computed from the time elapsed since
+    uint32_t *_states; // LEDs states bitset, storage provided by the sized driver template
     uint8_t _brightness;
     uint8_t _brightnessPrev;
     bool _direction;
-    bool _fillDownInit, _fillDownComplete;
-    bool _emptyDownInit, _emptyDownComplete;
-    bool _fillUpInit, _fillUpComplete;
-    int8_t _tracker;
-    uint8_t _prevHeatLevel;
+    int16_t _tracker; // Last rendered step, or sequence frame (fill then empty runs up to 2 * segments steps)
     bool _repeat;
+    const BarMeterFrameSequence *_sequence;
 
     uint32_t _lastBeatTime, _lastRandomUpdate;
     bool _isPeak;
     const uint8_t _MIN_BASE_LEVEL; // Default lower base level
-    const uint8_t _MIN_PEAK_LEVEL; // Peak should rise above level 20
+    const uint8_t _MIN_PEAK_LEVEL; // Peak should rise above this level
     uint8_t _randomOffset;
-    int8_t _currentLevel;
+    int16_t _currentLevel;
     uint8_t _peakLevel;            // Track the highest LED reached
     uint32_t _prevPeakUpdate;      // Timer for peak drop
     const uint8_t _PEAK_HOLD_TIME; // Peak LED decay interval
@@ -110,47 +135,121 @@ protected:
     uint8_t _fadeIn;
     uint8_t _fadeOut;
 
-    bool _fillUp(uint8_t speed, bool initialize);
-    bool _fillDown(uint8_t speed, bool initialize, bool fadein);
-    bool _emptyDown(uint8_t speed, bool initialize, bool fadeout);
-    bool _emptyUp(uint8_t speed, bool initialize);
+    void _start();
+    uint32_t _stepsSinceStart(uint8_t speed) const;
+    bool _newStep(int16_t step);
+    uint8_t _bounce(uint32_t step, uint8_t low, uint8_t high);
     void _setHigh();
     void _setLow();
     void _setLed(uint8_t index, bool state);
+    void _setRange(uint8_t from, uint8_t to, bool state);
+    void _setFrame(uint32_t frame, uint8_t width);
+    void _addToRuns(BarMeterRun *runs, uint8_t &runCount, uint8_t segment, uint8_t row, uint8_t bit);
+    uint16_t _runBits(const BarMeterRun &run) const;
+    void _sequenceSet(const BarMeterFrameSequence *sequence, bool reverse, bool repeat, bool restart);
+    bool _sequenceStep(uint8_t speed);
 };
 
 class HT16K33Driver : public BarMeterAnimation
 {
 public:
-    HT16K33Driver(const uint8_t *segNumber, const bool *direction, const uint8_t dataPin, const uint8_t clockPin, const uint8_t address, const uint8_t (*mapping)[2]);
+    HT16K33Driver(uint8_t segNumber, uint32_t *states, BarMeterRun *runs,
+                  const bool *direction, const uint8_t dataPin, const uint8_t clockPin, const uint8_t address, const uint8_t (*mapping)[2], uint32_t busClock, bool async);
     void begin();
     void update();
     void update(uint32_t syncCurrentTime);
+    uint8_t getFrameBytes() const;
 
 private:
     const bool *P_DIRECTION;
     const uint8_t _CLOCK_PIN;
     const uint8_t _DATA_PIN;
     const uint8_t _ADDRESS;
+    const uint32_t _BUS_CLOCK;
+    const bool _ASYNC;
     HT16K33 _driver;
     const uint8_t (*BM_SEG_MAP)[2]; // Pointer to mapping array
+    BarMeterRun *_runs;             // Segments runs per driver row, mapping and direction included
+    uint8_t _runCount;
+    uint16_t _rows[8];              // Frame image composed in RAM before flushing to the driver
+    uint8_t _frameBytes;            // Display RAM bytes sent by the last flushed frame
+
+    void _buildLookup();
+    void _composeRows();
 };
 
 class MAX72xxDriver : public BarMeterAnimation
 {
 public:
-    MAX72xxDriver(const uint8_t *segNumber, const bool *direction, const uint8_t dataPin, const uint8_t clockPin, const uint8_t loadPin, const uint8_t (*mapping)[2]);
+    MAX72xxDriver(uint8_t segNumber, uint32_t *states, BarMeterRun *runs, uint8_t *rows, uint8_t numDevices,
+                  const bool *direction, const uint8_t dataPin, const uint8_t clockPin, const uint8_t loadPin, const uint8_t (*mapping)[2], MAX72xxTransport transport);
     void begin();
     void update();
     void update(uint32_t syncCurrentTime);
+    void setDisplayRow(uint8_t device, uint8_t row, uint8_t value);
+    uint8_t getFrameTransfers() const;
+    void benchmark(Stream &out, uint16_t iterations);
 
 private:
     const bool *P_DIRECTION;
     const uint8_t _DATA_PIN;
     const uint8_t _CLOCK_PIN;
     const uint8_t _LOAD_PIN;
+    const MAX72xxTransport _TRANSPORT;
+    const uint8_t _NUM_DEVICES;
     MAX72xx _driver;
     const uint8_t (*BM_SEG_MAP)[2]; // Pointer to mapping array
+    BarMeterRun *_runs;             // Segments runs per driver row, mapping and direction included
+    uint8_t _runCount;
+    uint8_t *_rows;                 // Chain image, 8 rows per device : bar meter on device 0, additional displays after
+    uint8_t _frameTransfers;        // SPI transactions used by the last flushed frame
+
+    void _buildLookup();
+    void _composeRows();
+};
+
+/*************************************************************************************************************/
+/*   Sized bar meters : the segments number is a compile time parameter that sizes the states and segments   */
+/*   runs storage, the mapping array must have exactly SEGMENTS entries.                                     */
+/*************************************************************************************************************/
+
+template <uint8_t SEGMENTS>
+class HT16K33BarMeter : public HT16K33Driver
+{
+    static_assert(SEGMENTS >= 1 && SEGMENTS <= 128, "HT16K33 drives at most 128 segments (8 rows of 16)");
+
+public:
+    HT16K33BarMeter(const bool *direction, const uint8_t dataPin, const uint8_t clockPin, const uint8_t address, const uint8_t (&mapping)[SEGMENTS][2],
+                    uint32_t busClock = HT16K33_I2C_STANDARD, bool async = false)
+        : HT16K33Driver(SEGMENTS, _statesStorage, _runsStorage, direction, dataPin, clockPin, address, mapping, busClock, async),
+          _statesStorage{0}, _runsStorage{}
+    {
+    }
+
+private:
+    uint32_t _statesStorage[BM_STATE_WORDS(SEGMENTS)];
+    BarMeterRun _runsStorage[SEGMENTS]; // Worst case, one run per segment
+};
+
+// DEVICES : number of daisy chained MAX72xx, the bar meter is on the first one, the others are free for additional displays
+template <uint8_t SEGMENTS, uint8_t DEVICES = 1>
+class MAX72xxBarMeter : public MAX72xxDriver
+{
+    static_assert(SEGMENTS >= 1 && SEGMENTS <= 64, "MAX72xx drives at most 64 segments (8 rows of 8)");
+    static_assert(DEVICES >= 1 && DEVICES <= MAX72xx_MAX_DEVICES, "MAX72xx chain length out of range");
+
+public:
+    MAX72xxBarMeter(const bool *direction, const uint8_t dataPin, const uint8_t clockPin, const uint8_t loadPin, const uint8_t (&mapping)[SEGMENTS][2],
+                    MAX72xxTransport transport = MAX72xx_BITBANG)
+        : MAX72xxDriver(SEGMENTS, _statesStorage, _runsStorage, _rowsStorage, DEVICES, direction, dataPin, clockPin, loadPin, mapping, transport),
+          _statesStorage{0}, _runsStorage{}, _rowsStorage{0}
+    {
+    }
+
+private:
+    uint32_t _statesStorage[BM_STATE_WORDS(SEGMENTS)];
+    BarMeterRun _runsStorage[SEGMENTS]; // Worst case, one run per segment
+    uint8_t _rowsStorage[DEVICES * 8];
 };
 
 #endif
@@ -30,19 +30,44 @@
 
 // Some constants values for animations
 
+// Ring pixel fade curve indexed by the pixel relative phase (256 steps per turn), 0-255 :
+// fade in (x / 0.2)^4 on the first 20%, then trailing fade out (0.5 * (1 + cos(PI * (x - 0.2) / 0.8)))^4
+const uint8_t CYC_FADE_CURVE[256] PROGMEM = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,   2,
+      2,   3,   4,   5,   6,   7,   9,  10,  12,  14,  17,  20,  23,  26,  30,  34,
+     39,  44,  50,  56,  62,  70,  77,  86,  95, 105, 115, 127, 139, 152, 166, 181,
+    197, 214, 232, 251, 255, 255, 255, 254, 254, 253, 252, 251, 250, 249, 248, 247,
+    245, 244, 242, 240, 239, 237, 235, 232, 230, 228, 225, 223, 220, 218, 215, 212,
+    209, 207, 204, 201, 197, 194, 191, 188, 185, 181, 178, 175, 171, 168, 164, 161,
+    157, 154, 151, 147, 144, 140, 137, 133, 130, 126, 123, 120, 116, 113, 110, 107,
+    103, 100,  97,  94,  91,  88,  85,  82,  79,  76,  74,  71,  68,  66,  63,  61,
+     58,  56,  54,  51,  49,  47,  45,  43,  41,  39,  37,  36,  34,  32,  31,  29,
+     28,  26,  25,  23,  22,  21,  20,  19,  18,  17,  16,  15,  14,  13,  12,  11,
+     11,  10,   9,   9,   8,   7,   7,   6,   6,   5,   5,   5,   4,   4,   4,   3,
+      3,   3,   3,   2,   2,   2,   2,   2,   1,   1,   1,   1,   1,   1,   1,   1,
+      1,   1,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0
+};
+
+// Longest phase advance in one frame, a longer stall just skips
+#define CYC_MAX_DELTA_TIME 1000
+
 // Cyclotron object and functions
 
-Cyclotron::Cyclotron(Adafruit_NeoPixel *strip,
+Cyclotron::Cyclotron(LedsChain *strip,
                      const uint8_t *numLed, const uint8_t *start, const uint8_t *end,
-                     const uint8_t *ring1st, const uint8_t *ringLast, const uint8_t *center,
+                     const CycRing *rings, CycRingState *ringStates, uint8_t ringsNumber, const uint8_t *center,
                      const bool *direction)
     : LedsStrip(strip),
       P_NUMLEDS(numLed), P_START(start), P_END(end),
-      P_RING_1ST(ring1st), P_RING_LAST(ringLast), P_CENTER(center),
+      P_RINGS(rings), P_CENTER(center),
       P_DIRECTION(direction),
+      _RINGS_NUMBER(ringsNumber), _ringStates(ringStates),
       _cycle_mHz(100), _minBrightness(0), _maxBrightness(0),
-      _ini_mHz(100), _ini_minBr(0), _ini_maxBr(255),
-      _tg_cycle_mHz(100), _tg_minBrightness(0), _tg_maxBrightness(255)
+      _tg_cycle_mHz(100), _tg_minBrightness(0), _tg_maxBrightness(255),
+      _lastRotation(0)
 {
 }
 
@@ -54,6 +79,14 @@ void Cyclotron::begin()
 {
     DEBUG_PRINTLN("Cyclotron DEBUG ON");
 
+    // Rings state, the storage is owned by the sized template and only initialized after this base constructor
+    for (uint8_t r = 0; r < _RINGS_NUMBER; r++)
+    {
+        _ringStates[r].phase = 0;
+        // Clamped for a single pixel ring, a whole turn doesn't fit the 16 bits step and it is never used anyway
+        _ringStates[r].pixelPhaseStep = min(65536UL / (P_RINGS[r].last - P_RINGS[r].first + 1), 0xFFFFUL);
+    }
+
     Cyclotron::clear();
 }
 
@@ -68,20 +101,20 @@ void Cyclotron::rampInit(const CycParams &tg_params, uint16_t rampTime)
     _rampTime = rampTime;
 
     _tg_cycle_mHz = max(0, min(8000, tg_params.cycle_mHz));
-    _ini_mHz = _cycle_mHz;
+    _mHzRamp.init(_cycle_mHz, _tg_cycle_mHz, _rampTime, _iniTime, _updateSpeed);
 
     _tg_minBrightness = constrain(tg_params.minBrightness, 0, 255);
-    _ini_minBr = _minBrightness;
+    _minBrRamp.init(_minBrightness, _tg_minBrightness, _rampTime, _iniTime, _updateSpeed);
 
     _tg_maxBrightness = constrain(tg_params.maxBrightness, 0, 255);
-    _ini_maxBr = _maxBrightness;
+    _maxBrRamp.init(_maxBrightness, _tg_maxBrightness, _rampTime, _iniTime, _updateSpeed);
 
     /*
     DEBUG_PRINTLN("Cyclotron rampInit :");
     DEBUG_PRINTLN("_iniTime " + String(_iniTime) + "  _rampTime " + String(_rampTime));
-    DEBUG_PRINTLN("_tg_cycle_mHz " + String(_tg_cycle_mHz) + "  _ini_mHz " + String(_ini_mHz));
-    DEBUG_PRINTLN("_tg_minBrightness " + String(_tg_minBrightness) + "  _ini_minBr " + String(_ini_minBr));
-    DEBUG_PRINTLN("_tg_maxBrightness " + String(_tg_maxBrightness) + "  _ini_maxBr " + String(_ini_maxBr));
+    DEBUG_PRINTLN("_tg_cycle_mHz " + String(_tg_cycle_mHz) + "  _cycle_mHz " + String(_cycle_mHz));
+    DEBUG_PRINTLN("_tg_minBrightness " + String(_tg_minBrightness) + "  _minBrightness " + String(_minBrightness));
+    DEBUG_PRINTLN("_tg_maxBrightness " + String(_tg_maxBrightness) + "  _maxBrightness " + String(_maxBrightness));
     DEBUG_PRINTLN();
     */
 }
@@ -109,73 +142,144 @@ void Cyclotron::ramp()
         }
 
         // Ramp cyclotron
-        _cycle_mHz = _rampParameter(_iniTime, _rampTime, _ini_mHz, _tg_cycle_mHz, _updateSpeed);
-        _minBrightness = _rampParameter(_iniTime, _rampTime, _ini_minBr, _tg_minBrightness, _updateSpeed);
-        _maxBrightness = _rampParameter(_iniTime, _rampTime, _ini_maxBr, _tg_maxBrightness, _updateSpeed);
+        _cycle_mHz = _mHzRamp.step(_currentTime);
+        _minBrightness = _minBrRamp.step(_currentTime);
+        _maxBrightness = _maxBrRamp.step(_currentTime);
         // DEBUG_PRINTLN("_cycle_mHz " + String(_cycle_mHz) + "  _minBrightness " + String(_minBrightness) + "  _maxBrightness " + String(_maxBrightness));
     }
 }
 
 void Cyclotron::_rotation(uint16_t cycle_mHz, uint8_t minBrightness, uint8_t maxBrightness)
 {
-    // Clear all LEDs before updating
-    _setColorAll(*P_START, *P_END, 0, 0, 0);
+    // Compute elapsed time since last update
+    uint16_t deltaTime = min(_currentTime - _lastRotation, (uint32_t)CYC_MAX_DELTA_TIME);
+    _lastRotation = _currentTime;
+
+    // Phase advance at the cyclotron speed : mHz * 65536 / 1000000 Q16 steps per ms, computed as (mHz * 4295 / 256) / 256
+    uint32_t phasePerMs = ((uint32_t)cycle_mHz * 4295) >> 8;
+    uint32_t phaseAdvance = (deltaTime * phasePerMs) >> 8;
 
+    for (uint8_t r = 0; r < _RINGS_NUMBER; r++)
+        _ringRotation(P_RINGS[r], _ringStates[r], phaseAdvance, minBrightness, maxBrightness);
+
+    if (*P_CENTER != CYC_NO_CENTER)
+        _CycSetColor(*P_CENTER, minBrightness, minBrightness / 40, 0);
+}
+
+void Cyclotron::_ringRotation(const CycRing &ring, CycRingState &state, uint32_t phaseAdvance, uint8_t minBrightness, uint8_t maxBrightness)
+{
     // Number of LEDs in the ring
-    uint8_t ringSize = *P_RING_LAST - *P_RING_1ST + 1;
+    uint8_t ringSize = ring.last - ring.first + 1;
 
-    // Track phase as a continuously increasing value
-    static float phase = 0.0;
+    // Advance the phase at the ring speed, the turn wrap around is free with the 16 bits phase
+    state.phase += (phaseAdvance * ring.speed) >> 4;
 
-    // Compute elapsed time since last update
-    static uint32_t lastUpdateTime = 0;
-    float deltaTime = (_currentTime - lastUpdateTime) / 1000.0; // Convert to seconds
-    lastUpdateTime = _currentTime;
+    // Loop through all ring LEDs, each one a fraction of turn behind the previous one
+    uint16_t relativePhase = state.phase;
+    uint8_t range = maxBrightness - minBrightness;
+    for (uint8_t i = 0; i < ringSize; i++)
+    {
+        // Fade curve, interpolated between two table steps with the phase low byte
+        uint8_t index = relativePhase >> 8;
+        int16_t fade = pgm_read_byte(&CYC_FADE_CURVE[index]);
+        int16_t next = pgm_read_byte(&CYC_FADE_CURVE[(uint8_t)(index + 1)]);
+        fade += ((int32_t)(next - fade) * (relativePhase & 0xFF)) >> 8; // 32 bits product, int is 16 bits on AVR
+
+        // Scaled over the brightness range, 255 is mapped to 256 to reach the max brightness
+        uint8_t brightness = minBrightness + (((uint16_t)range * (uint16_t)(fade + (fade >> 7))) >> 8);
+
+        // Set color, a reversed ring turns the other way
+        _CycSetColor(ring.reverse ? ring.last - i : ring.first + i, brightness, 0, 0);
+
+        relativePhase -= state.pixelPhaseStep;
+    }
+}
+
+void Cyclotron::_rotationFloat(float &phase, uint16_t deltaTime, uint16_t cycle_mHz, uint8_t minBrightness, uint8_t maxBrightness)
+{
+    // Original floating point renderer, only kept as the benchmark reference, all rings share the same phase
 
     // Increment phase smoothly, handling speed changes
-    phase += deltaTime * (cycle_mHz / 1000.0); // Convert mHz to Hz
+    phase += deltaTime / 1000.0 * (cycle_mHz / 1000.0); // Convert mHz to Hz
 
     // Ensure phase stays within [0,1] range
     phase = fmod(phase, 1.0);
 
-    // Loop through all ring LEDs
-    for (uint8_t i = 0; i < ringSize; i++)
+    for (uint8_t r = 0; r < _RINGS_NUMBER; r++)
     {
-        // Calculate offset per LED
-        float ledOffset = (float)i / (ringSize);
-        float relativePhase = phase - ledOffset;
-
-        // Ensure relativePhase stays within [0,1] range
-        if (relativePhase < 0)
-            relativePhase += 1.0;
-
-        // Apply asymmetric sine wave for trailing fade-out effect
-        float fadeSharpness = 4.0; // Minimum value = 1.0, recommended 2.5 to 5.0, maximum 7.0 to 8.0
-        float fadeFactor;
-        if (relativePhase < 0.2)
-        {
-            // Fade-in effect for the first two pixels
-            fadeFactor = pow(relativePhase / 0.2, fadeSharpness);
-        }
-        else
+        // Number of LEDs in the ring
+        uint8_t ringSize = P_RINGS[r].last - P_RINGS[r].first + 1;
+
+        // Loop through all ring LEDs
+        for (uint8_t i = 0; i < ringSize; i++)
         {
-            // Trailing fade-out curve
-            fadeFactor = pow(0.5 * (1 + cos(PI * (relativePhase - 0.2) / 0.8)), fadeSharpness);
+            // Calculate offset per LED
+            float ledOffset = (float)i / (ringSize);
+            float relativePhase = phase - ledOffset;
+
+            // Ensure relativePhase stays within [0,1] range
+            if (relativePhase < 0)
+                relativePhase += 1.0;
+
+            // Apply asymmetric sine wave for trailing fade-out effect
+            float fadeSharpness = 4.0; // Minimum value = 1.0, recommended 2.5 to 5.0, maximum 7.0 to 8.0
+            float fadeFactor;
+            if (relativePhase < 0.2)
+            {
+                // Fade-in effect for the first two pixels
+                fadeFactor = pow(relativePhase / 0.2, fadeSharpness);
+            }
+            else
+            {
+                // Trailing fade-out curve
+                fadeFactor = pow(0.5 * (1 + cos(PI * (relativePhase - 0.2) / 0.8)), fadeSharpness);
+            }
+
+            // Scale the fadeFactor with a minimum brightness base
+            float brightnessFactor = minBrightness + (maxBrightness - minBrightness) * fadeFactor;
+
+            // Set color
+            _CycSetColor(P_RINGS[r].first + i, (uint8_t)(brightnessFactor), 0, 0);
         }
+    }
 
-        // Scale the fadeFactor with a minimum brightness base
-        float brightnessFactor = minBrightness + (maxBrightness - minBrightness) * fadeFactor;
+    if (*P_CENTER != CYC_NO_CENTER)
+        _CycSetColor(*P_CENTER, minBrightness, minBrightness / 40, 0);
+}
 
-        // Apply brightness scaling
-        uint8_t brightness = (uint8_t)(brightnessFactor);
-        uint8_t red = brightness;
-        // uint8_t green = brightness / 40; // Slight orange tint
+void Cyclotron::benchmark(Stream &out, uint16_t frames)
+{
+    if (frames == 0)
+        return;
 
-        // Set color
-        _CycSetColor(*P_RING_1ST + i, red, 0 /*green*/, 0);
-    }
+    // Render frames 10ms apart at full speed, with the integer then the floating point renderer
+    uint32_t savedTime = _currentTime;
+    float floatPhase = 0.0;
 
-    _CycSetColor(*P_CENTER, minBrightness, minBrightness / 40, 0);
+    uint32_t start = micros();
+    for (uint16_t i = 0; i < frames; i++)
+    {
+        _currentTime += 10;
+        _rotation(CYC_BURST_WARNING.cycle_mHz, CYC_BURST_WARNING.minBrightness, CYC_BURST_WARNING.maxBrightness);
+    }
+    uint32_t fixedTime = micros() - start;
+
+    start = micros();
+    for (uint16_t i = 0; i < frames; i++)
+        _rotationFloat(floatPhase, 10, CYC_BURST_WARNING.cycle_mHz, CYC_BURST_WARNING.minBrightness, CYC_BURST_WARNING.maxBrightness);
+    uint32_t floatTime = micros() - start;
+
+    out.print("Cyclotron fixed point : ");
+    out.print(fixedTime * clockCyclesPerMicrosecond() / frames);
+    out.println(" cycles per frame");
+    out.print("Cyclotron float       : ");
+    out.print(floatTime * clockCyclesPerMicrosecond() / frames);
+    out.println(" cycles per frame");
+
+    // Back to the animation time line, with a dark ring
+    _currentTime = savedTime;
+    _lastRotation = savedTime;
+    clear();
 }
 
 void Cyclotron::_CycSetColor(uint16_t pixel, uint8_t red, uint8_t green, uint8_t blue)
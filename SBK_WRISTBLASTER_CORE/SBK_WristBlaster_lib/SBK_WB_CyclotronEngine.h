@@ -46,35 +46,85 @@ const CycParams CYC_CAPTURE_WARNING = {4000, 75, 255};
 const CycParams CYC_BURST_MAX = {6000, 50, 204};
 const CycParams CYC_BURST_WARNING = {8000, 100, 255};
 
+// Cyclotron ring : first and last pixels from the cyclotron start index, and the ring speed
+// relative to the cyclotron speed in 1/16 (16 : same speed, 8 : half speed, 32 : twice as fast)
+struct CycRing
+{
+    uint8_t first;
+    uint8_t last;
+    uint8_t speed;
+    bool reverse;
+};
+
+// Cyclotron ring running state, storage provided by the sized template
+struct CycRingState
+{
+    uint16_t phase;          // Rotation phase, Q16 : 65536 is a full turn
+    uint16_t pixelPhaseStep; // Phase offset between two ring pixels, Q16
+};
+
+// No center pixel on the cyclotron
+#ifndef CYC_NO_CENTER
+#define CYC_NO_CENTER 255
+#endif
+
 class Cyclotron : public LedsStrip
 {
 public:
-    Cyclotron(Adafruit_NeoPixel *strip,const uint8_t *numLed, const uint8_t *start, const uint8_t *end,
-              const uint8_t *ring1st, const uint8_t *ringLast, const uint8_t *center,
+    Cyclotron(LedsChain *strip, const uint8_t *numLed, const uint8_t *start, const uint8_t *end,
+              const CycRing *rings, CycRingState *ringStates, uint8_t ringsNumber, const uint8_t *center,
               const bool *direction);
     ~Cyclotron();
     void begin();
     void clear();
     void rampInit(const CycParams &tg_params, uint16_t rampTime);
     void ramp();
+    void benchmark(Stream &out, uint16_t frames);
 
 private:
     const uint8_t *P_NUMLEDS, *P_START, *P_END;
-    const uint8_t *P_RING_1ST, *P_RING_LAST, *P_CENTER;
+    const CycRing *P_RINGS;
+    const uint8_t *P_CENTER;
     const bool *P_DIRECTION;
+    const uint8_t _RINGS_NUMBER;
+    CycRingState *_ringStates;
     uint16_t _cycle_mHz;
     uint8_t _minBrightness;
     uint8_t _maxBrightness;
-    uint16_t _ini_mHz;  //, _incr_mHz;
-    uint8_t _ini_minBr; //, _incr_minBr;
-    uint8_t _ini_maxBr; //, _incr_maxBr;
+    LedsRamp _mHzRamp;
+    LedsRamp _minBrRamp;
+    LedsRamp _maxBrRamp;
     uint16_t _tg_cycle_mHz;
     uint8_t _tg_minBrightness;
     uint8_t _tg_maxBrightness;
-
+    uint32_t _lastRotation; // Time of the last phase advance
 
     void _CycSetColor(uint16_t pixel, uint8_t red, uint8_t green, uint8_t blue);
     void _rotation(uint16_t cycle_mHz, uint8_t minBrightness, uint8_t maxBrightness);
+    void _ringRotation(const CycRing &ring, CycRingState &state, uint32_t phaseAdvance, uint8_t minBrightness, uint8_t maxBrightness);
+    void _rotationFloat(float &phase, uint16_t deltaTime, uint16_t cycle_mHz, uint8_t minBrightness, uint8_t maxBrightness);
+};
+
+/*************************************************************************************************************/
+/*   Sized cyclotron : the rings number is a compile time parameter that sizes the rings state storage,      */
+/*   the rings array must have exactly RINGS entries.                                                        */
+/*************************************************************************************************************/
+
+template <uint8_t RINGS>
+class CyclotronRings : public Cyclotron
+{
+    static_assert(RINGS >= 1, "Cyclotron needs at least one ring");
+
+public:
+    CyclotronRings(LedsChain *strip, const uint8_t *numLed, const uint8_t *start, const uint8_t *end,
+                   const CycRing (&rings)[RINGS], const uint8_t *center, const bool *direction)
+        : Cyclotron(strip, numLed, start, end, rings, _ringStatesStorage, RINGS, center, direction),
+          _ringStatesStorage{}
+    {
+    }
+
+private:
+    CycRingState _ringStatesStorage[RINGS];
 };
 
 #endif
@@ -14,6 +14,15 @@
 
  #include "SBK_WB_HT16K33.h"
 
+/**
+ * Interrupt driven TX state: one frame (RAM address + up to 16 data bytes) in flight at a time.
+ */
+static uint8_t _txBuffer[HT16K33_RAM_SIZE + 1];
+static volatile uint8_t _txLength = 0;
+static volatile uint8_t _txIndex = 0;
+static volatile bool _txBusy = false;   // flush in flight
+static volatile bool _txFailed = false; // last flush was not acknowledged, display RAM content is unknown
+
 /**
  * Utility function to flip a 16-bit integer. There may be better ways of doing this—let me know!
  */
@@ -33,18 +42,28 @@ uint16_t _flip_uint16(uint16_t in)
 
 // Constructor
 void HT16K33::init(uint8_t addr)
+{
+  init(addr, HT16K33_I2C_STANDARD);
+}
+
+/**
+ * Same as init(addr), with the I2C bus clock to use: HT16K33_I2C_FAST (400kHz) cuts a full frame time by about 4.
+ */
+void HT16K33::init(uint8_t addr, uint32_t busClock)
 {
   // orientation flags
   resetOrientation();
   
   // set the I2C address
   _i2c_addr = addr;
+  _async = false;
   
-  // assign + zero some buffer data
-  _buffer = (uint16_t*)calloc(8, sizeof(uint16_t));
+  // zero the buffer data
+  memset(_buffer, 0, sizeof(_buffer));
   
   // start everything
   Wire.begin();
+  Wire.setClock(busClock);
   Wire.beginTransmission(_i2c_addr);
   Wire.write(0x21); // turn it on
   Wire.endTransmission();
@@ -53,8 +72,8 @@ void HT16K33::init(uint8_t addr)
   setBlink(HT16K33_BLINK_OFF);
   setBrightness(15);
   
-  // write the matrix, just in case
-  write();
+  // write the whole matrix, just in case
+  writeAll();
 }
 
 /**
@@ -175,47 +194,196 @@ void HT16K33::setColumn(uint8_t col, uint8_t value)
 
 
 /**
- * Write the RAM buffer to the matrix.
+ * Write the RAM buffer to the matrix. Only the range between the first and the last byte that changed since
+ * the previous write is sent, in one I2C transaction starting at the first changed address.
  */
 void HT16K33::write(void)
 {
-  Wire.beginTransmission(_i2c_addr);
-  Wire.write(HT16K33_CMD_RAM);
-  
+  uint8_t ram[HT16K33_RAM_SIZE];
+  composeRam(ram);
+
+  // a failed interrupt driven flush leaves the display RAM unknown, send it all
+  if (_txFailed)
+  {
+    _txFailed = false;
+    writeRange(ram, 0, HT16K33_RAM_SIZE - 1);
+    return;
+  }
+
+  // find the dirty address range
+  uint8_t first = 0;
+  while (first < HT16K33_RAM_SIZE && ram[first] == _ram[first])
+  {
+    first++;
+  }
+
+  if (first == HT16K33_RAM_SIZE)
+  {
+    _lastWriteSize = 0; // nothing changed
+    return;
+  }
+
+  uint8_t last = HT16K33_RAM_SIZE - 1;
+  while (ram[last] == _ram[last])
+  {
+    last--;
+  }
+
+  writeRange(ram, first, last);
+}
+
+/**
+ * Write the whole RAM buffer to the matrix, whatever was sent before.
+ */
+void HT16K33::writeAll(void)
+{
+  uint8_t ram[HT16K33_RAM_SIZE];
+  composeRam(ram);
+  writeRange(ram, 0, HT16K33_RAM_SIZE - 1);
+}
+
+/**
+ * Number of data bytes sent by the last write, 0 if nothing had changed.
+ */
+uint8_t HT16K33::getLastWriteSize(void) const
+{
+  return _lastWriteSize;
+}
+
+/**
+ * Build the display RAM image from the buffer, orientation included.
+ */
+void HT16K33::composeRam(uint8_t *ram)
+{
   for (uint8_t row = 0; row < 8; row++)
   {
-    writeRow(row);
+    // flip vertically
+    uint16_t out = _buffer[_vFlipped ? 7 - row : row];
+
+    // flip horizontally
+    if (_hFlipped)
+    {
+      out = _flip_uint16(out);
+    }
+
+    if (_reversed)
+    {
+      ram[row * 2] = out >> 8;       // second byte
+      ram[row * 2 + 1] = out & 0xFF; // first byte
+    }
+    else
+    {
+      ram[row * 2] = out & 0xFF; // first byte
+      ram[row * 2 + 1] = out >> 8; // second byte
+    }
   }
-  
+}
+
+/**
+ * Send RAM bytes first to last: the address pointer auto increments after each data byte.
+ * In async mode the bytes are queued and sent from the TWI interrupt, this returns right away.
+ */
+void HT16K33::writeRange(const uint8_t *ram, uint8_t first, uint8_t last)
+{
+  _lastWriteSize = last - first + 1;
+
+#ifdef HT16K33_ASYNC_AVAILABLE
+  if (_async)
+  {
+    // the previous flush must be complete, see isBusy()
+    while (_txBusy)
+    {
+    }
+
+    _txBuffer[0] = HT16K33_CMD_RAM | first;
+    for (uint8_t i = first; i <= last; i++)
+    {
+      _txBuffer[i - first + 1] = ram[i];
+      _ram[i] = ram[i];
+    }
+    _txLength = _lastWriteSize + 1;
+    _txIndex = 0;
+    _txBusy = true;
+
+    // the START and address are sent by writing MADDR, each following byte is sent from the interrupt
+    TWI0.MCTRLA |= TWI_WIEN_bm;
+    TWI0.MADDR = _i2c_addr << 1;
+    return;
+  }
+#endif
+
+  Wire.beginTransmission(_i2c_addr);
+  Wire.write(HT16K33_CMD_RAM | first);
+
+  for (uint8_t i = first; i <= last; i++)
+  {
+    Wire.write(ram[i]);
+    _ram[i] = ram[i];
+  }
+
   Wire.endTransmission();
 }
 
 /**
- * Write a row to the chip.
+ * Enable interrupt driven writes, returns the mode in use: false if not available on this architecture.
+ * Other commands (brightness, blink) still go through Wire and must not be sent while isBusy().
  */
-void HT16K33::writeRow(uint8_t row)
+bool HT16K33::setAsync(bool async)
 {
-  // flip vertically
-  if (_vFlipped)
+#ifdef HT16K33_ASYNC_AVAILABLE
+  while (_txBusy)
   {
-    row = 7 - row;
   }
-  
-  // read out the buffer so we can flip horizontally
-  uint16_t out = _buffer[row];
-  if (_hFlipped)
+  _async = async;
+#else
+  (void)async;
+  _async = false;
+#endif
+  return _async;
+}
+
+/**
+ * True while an interrupt driven flush is in flight.
+ */
+bool HT16K33::isBusy(void) const
+{
+  return _txBusy;
+}
+
+#ifdef HT16K33_ASYNC_AVAILABLE
+/**
+ * TWI master interrupt: raised once the address or a data byte has been sent, or on bus error.
+ */
+ISR(TWI0_TWIM_vect)
+{
+  uint8_t status = TWI0.MSTATUS;
+
+  if (status & (TWI_ARBLOST_bm | TWI_BUSERR_bm))
   {
-    out = _flip_uint16(out);
+    // lost arbitration or bus error: the bus is not ours, give up this frame without a STOP
+    TWI0.MSTATUS = TWI_ARBLOST_bm | TWI_BUSERR_bm;
+    TWI0.MCTRLA &= ~TWI_WIEN_bm;
+    _txFailed = true;
+    _txBusy = false;
+    return;
   }
-  
-  if (_reversed)
+
+  if (status & TWI_RXACK_bm)
   {
-    Wire.write(out >> 8); // second byte
-    Wire.write(out & 0xFF); // first byte
+    // not acknowledged: give up this frame, the STOP below releases the bus
+    _txFailed = true;
+    _txIndex = _txLength;
+  }
+
+  if (_txIndex < _txLength)
+  {
+    TWI0.MDATA = _txBuffer[_txIndex++];
   }
   else
   {
-    Wire.write(out & 0xFF); // first byte
-    Wire.write(out >> 8); // second byte
+    TWI0.MCTRLB = TWI_MCMD_STOP_gc;
+    TWI0.MCTRLA &= ~TWI_WIEN_bm;
+    _txBusy = false;
   }
-}
\ No newline at end of file
+}
+#endif
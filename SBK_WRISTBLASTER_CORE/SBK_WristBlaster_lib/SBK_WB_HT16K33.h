@@ -35,11 +35,29 @@
 #define HT16K33_BLINK_2HZ 0x04
 #define HT16K33_BLINK_0HZ5 0x06
 
+// I2C bus clock, the HT16K33 supports fast mode
+#define HT16K33_I2C_STANDARD 100000
+#define HT16K33_I2C_FAST 400000
+
+// display RAM size in bytes, 8 rows of 16 bits
+#define HT16K33_RAM_SIZE 16
+
+// interrupt driven writes are opt-in : uncomment to build the TWI0 master interrupt, which then belongs to this driver.
+// Keep it commented with the MAX72xx bar meter driver, or when another I2C device needs the TWI0 interrupt.
+// #define HT16K33_ASYNC
+
+// interrupt driven writes need the megaAVR TWI master interrupt, not used by the Wire library of the Arduino megaAVR core
+// (megaTinyCore and DxCore Wire may own TWI0_TWIM_vect)
+#if defined(HT16K33_ASYNC) && defined(ARDUINO_ARCH_MEGAAVR) && defined(TWI0) && defined(TWI_WIEN_bm)
+#define HT16K33_ASYNC_AVAILABLE
+#endif
+
 // actual class
 class HT16K33
 {
 public:
   void init(uint8_t addr);
+  void init(uint8_t addr, uint32_t busClock);
 
   // brightness control
   void setBrightness(uint8_t brightness);
@@ -61,15 +79,25 @@ public:
 
   // read/write
   void write(void);
+  void writeAll(void);
+  uint8_t getLastWriteSize(void) const;
+
+  // interrupt driven writes
+  bool setAsync(bool async);
+  bool isBusy(void) const;
 
 private:
-  uint16_t *_buffer;
+  uint16_t _buffer[8];
+  uint8_t _ram[HT16K33_RAM_SIZE]; // display RAM content as last sent to the chip
+  uint8_t _lastWriteSize;         // data bytes sent by the last write
   uint8_t _i2c_addr;
   bool _reversed;
   bool _vFlipped;
   bool _hFlipped;
+  bool _async;
 
-  void writeRow(uint8_t row);
+  void composeRam(uint8_t *ram);
+  void writeRange(const uint8_t *ram, uint8_t first, uint8_t last);
 };
 
 #endif 
@@ -0,0 +1,66 @@
+/*
+ *  This code is part of SBK_WRISTBLASTER_CORE (VERSION 0), a codebase for animations and effects
+ *  of a Wrist Blaster prop inspired by the movie Ghostbusters: Frozen Empire.
+ *  Copyright (c) 2025 Samuel Barabé
+ *
+ *  For more information, visit the project page: <https://github.com/sbarabe/SBK_WRISTBLASTER_CORE>.
+ *
+ *  This work is licensed under the Creative Commons Attribution 4.0 International License (CC BY 4.0).
+ *  You are free to share, copy, and modify this code as long as appropriate credit is given to the author.
+ *  See the full license at: <https://creativecommons.org/licenses/by/4.0/>.
+ *
+ *  This code is provided "as-is" without any warranty of any kind, either expressed or implied,
+ *  including but not limited to the warranties of merchantability or fitness for a particular purpose.
+ *  See the full license text for more details.
+ */
+
+#ifndef SBK_WB_HEAPCHECK_H
+#define SBK_WB_HEAPCHECK_H
+
+#include <Arduino.h>
+
+/*************************************************************************************************************/
+/*   Heap free build check, included once by the config : all the engines storage is static, so a build     */
+/*   without DEBUG_TO_SERIAL must not link the allocator. These replacements call a symbol defined nowhere. */
+/*   The linker drops them when nothing calls them (--gc-sections, Arduino default), otherwise the link     */
+/*   fails on "undefined reference to heap_allocation_is_not_allowed" : something still allocates (String, */
+/*   new, or an engine file with its own DEBUG_TO_SERIAL enabled).                                          */
+/*   free() is the one known reference : the Adafruit_NeoPixel destructor, only run if main() returned,     */
+/*   on the static chain buffers. It is a no-op here, which keeps avr-libc malloc.o (malloc and free) out.  */
+/*************************************************************************************************************/
+
+#ifndef DEBUG_TO_SERIAL
+
+extern "C"
+{
+    void heap_allocation_is_not_allowed(void);
+
+    void *malloc(size_t size)
+    {
+        (void)size;
+        heap_allocation_is_not_allowed();
+        return nullptr;
+    }
+
+    void *calloc(size_t count, size_t size)
+    {
+        (void)count;
+        (void)size;
+        heap_allocation_is_not_allowed();
+        return nullptr;
+    }
+
+    void *realloc(void *ptr, size_t size)
+    {
+        (void)ptr;
+        (void)size;
+        heap_allocation_is_not_allowed();
+        return nullptr;
+    }
+
+    void free(void *ptr) { (void)ptr; }
+}
+
+#endif
+
+#endif
@@ -26,16 +26,14 @@
 #endif
 
 
-Indicator::Indicator(Adafruit_NeoPixel *strip, const uint8_t *pixel, const char *name)
+Indicator::Indicator(LedsChain *strip, const uint8_t *pixel, const char *name)
     : LedsStrip(strip),
       P_PIXEL(pixel),
-      _tg_r(0), _ini_r(0),
-      _tg_g(0), _ini_g(0),
-      _tg_b(0), _ini_b(0),
+      _tg_r(0), _tg_g(0), _tg_b(0),
       _tg_brightness(100),
       _pulse(false),
       _blinkInt(0), _wasBlinking(false),
-      _ini_blinkInt(0), _tg_blinkInt(0)
+      _tg_blinkInt(0)
 {
     _NAME = name;
 }
@@ -93,12 +91,7 @@ void Indicator::initParam(const uint8_t color[3], uint8_t tg_brightness,
     uint8_t currentRed, currentGreen, currentBlue;
     _getCurrentColor(*P_PIXEL, currentRed, currentGreen, currentBlue);
 
-    // Get initial parameters
     _iniTime = _currentTime;
-    _ini_r = currentRed;
-    _ini_g = currentGreen;
-    _ini_b = currentBlue;
-    _ini_blinkInt = _blinkInt;
 
     // Check boundaries
     _rampTime = max(0, rampTime);
@@ -113,6 +106,12 @@ void Indicator::initParam(const uint8_t color[3], uint8_t tg_brightness,
     _tg_g = (_tg_g * _tg_brightness) / 100;
     _tg_b = (_tg_b * _tg_brightness) / 100;
 
+    // Ramps from the current parameters
+    _rRamp.init(currentRed, _tg_r, _rampTime, _iniTime, _updateSpeed);
+    _gRamp.init(currentGreen, _tg_g, _rampTime, _iniTime, _updateSpeed);
+    _bRamp.init(currentBlue, _tg_b, _rampTime, _iniTime, _updateSpeed);
+    _blinkIntRamp.init(_blinkInt, _tg_blinkInt, _rampTime, _iniTime, _updateSpeed);
+
     if (_rampTime == 0)
     {
         _setColor(*P_PIXEL, _tg_r, _tg_g, _tg_b);
@@ -129,11 +128,11 @@ void Indicator::initParam(const uint8_t color[3], uint8_t tg_brightness,
     // if (_NAME == "IND_SlBlw")
     // {
     // DEBUG_PRINTLN("Indicator " + String(_NAME) + "  animation init:");
-    // DEBUG_PRINTLN("_iniTime " + String(_iniTime) + "  _ini_blinkInt " + String(_ini_blinkInt) + "  _rampTime " + String(_rampTime));
+    // DEBUG_PRINTLN("_iniTime " + String(_iniTime) + "  _blinkInt " + String(_blinkInt) + "  _rampTime " + String(_rampTime));
     // DEBUG_PRINTLN("_tg_brightness " + String(_tg_brightness) + "  tg_blinkInt " + String(tg_blinkInt));
-    // DEBUG_PRINTLN("_tg_r " + String(_tg_r) + "  _ini_r " + String(_ini_r) + "  currentRed " + String(currentRed));
-    // DEBUG_PRINTLN("_tg_g " + String(_tg_g) + "  _ini_g " + String(_ini_g) + "  currentGreen " + String(currentGreen));
-    // DEBUG_PRINTLN("_tg_b " + String(_tg_b) + "  _ini_b " + String(_ini_b) + "  currentBlue " + String(currentBlue));
+    // DEBUG_PRINTLN("_tg_r " + String(_tg_r) + "  currentRed " + String(currentRed));
+    // DEBUG_PRINTLN("_tg_g " + String(_tg_g) + "  currentGreen " + String(currentGreen));
+    // DEBUG_PRINTLN("_tg_b " + String(_tg_b) + "  currentBlue " + String(currentBlue));
     // DEBUG_PRINTLN();
     // }
 }
@@ -162,7 +161,7 @@ void Indicator::blink(bool enableBlinkIntRamp)
 
     // Ramp blink interval if enable
     if (_blinkInt != _tg_blinkInt)
-        _blinkInt = (enableBlinkIntRamp) ? _rampParameter(_iniTime, _rampTime, _ini_blinkInt, _tg_blinkInt, _updateSpeed) : _tg_blinkInt;
+        _blinkInt = (enableBlinkIntRamp) ? _blinkIntRamp.step(_currentTime) : _tg_blinkInt;
 
     // Toggle blinking pulse
     if (_currentTime - _prevBlink >= _blinkInt)
@@ -205,9 +204,9 @@ bool Indicator::ramp()
     {
         _prevUpdate = _currentTime;
 
-        _setColor(*P_PIXEL, _rampParameter(_iniTime, _rampTime, _ini_r, _tg_r, _updateSpeed),
-                  _rampParameter(_iniTime, _rampTime, _ini_g, _tg_g, _updateSpeed),
-                  _rampParameter(_iniTime, _rampTime, _ini_b, _tg_b, _updateSpeed));
+        _setColor(*P_PIXEL, _rRamp.step(_currentTime),
+                  _gRamp.step(_currentTime),
+                  _bRamp.step(_currentTime));
     }
     return false;
 }
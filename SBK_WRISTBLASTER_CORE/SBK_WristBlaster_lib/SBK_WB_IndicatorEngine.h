@@ -51,7 +51,7 @@
 class Indicator : public LedsStrip
 {
 public:
-    Indicator(Adafruit_NeoPixel *strip, const uint8_t *pixel, const char *name);
+    Indicator(LedsChain *strip, const uint8_t *pixel, const char *name);
     void begin();
     void clear();
     void initParam(const uint8_t color[3], uint8_t tg_brightness);
@@ -71,15 +71,15 @@ public:
 private:
     const uint8_t *P_PIXEL;
     const char *_NAME; // Store name
-    uint8_t _tg_r, _ini_r;
-    uint8_t _tg_g, _ini_g;
-    uint8_t _tg_b, _ini_b;
+    uint8_t _tg_r, _tg_g, _tg_b;
+    LedsRamp _rRamp, _gRamp, _bRamp;
     uint8_t _tg_brightness;
     bool _pulse;
     uint32_t _prevBlink;
     uint16_t _blinkInt;
     bool _wasBlinking;
-    uint16_t _ini_blinkInt, _tg_blinkInt;
+    uint16_t _tg_blinkInt;
+    LedsRamp _blinkIntRamp;
 };
 
 class SingleColorIndicator
@@ -28,7 +28,311 @@
 #define DEBUG_PRINT(x)
 #endif
 
-LedsStrip::LedsStrip(Adafruit_NeoPixel *strip)
+/*************************************************************************************************************/
+/*                         Frame scheduler                                                                   */
+/*************************************************************************************************************/
+
+FrameScheduler::FrameScheduler(uint16_t frameRate, uint8_t maxDeferredFrames)
+    : _FRAME_PERIOD(1000000UL / max((uint16_t)1, frameRate)),
+      _MAX_DEFERRED(maxDeferredFrames), _deferStreak(0),
+      _nextFrame(0), _frameStart(0)
+{
+    resetStats();
+}
+
+void FrameScheduler::begin()
+{
+    _nextFrame = micros();
+    resetStats();
+}
+
+bool FrameScheduler::tick()
+{
+    uint32_t now = micros();
+
+    if ((int32_t)(now - _nextFrame) < 0)
+        return false;
+
+    uint32_t lateness = now - _nextFrame;
+    if (lateness >= _FRAME_PERIOD)
+    {
+        // A whole frame was missed (blocking audio command, long I2C...), restart the grid instead of bursting frames
+        _lateFrames++;
+        _nextFrame = now + _FRAME_PERIOD;
+    }
+    else
+        _nextFrame += _FRAME_PERIOD;
+
+    _maxLateness = min((uint32_t)0xFFFF, max((uint32_t)_maxLateness, lateness));
+    _frameStart = now;
+    return true;
+}
+
+// Ask to hold this frame push, the pixels stay dirty in the chain framebuffer for the next tick.
+// Returns false when the push was already deferred too many times in a row and must go now.
+bool FrameScheduler::defer()
+{
+    if (_deferStreak >= _MAX_DEFERRED)
+        return false;
+
+    _deferStreak++;
+    _deferredFrames++;
+    return true;
+}
+
+void FrameScheduler::frameDone(bool pushed)
+{
+    uint32_t frameTime = micros() - _frameStart;
+
+    _frames++;
+    if (pushed)
+    {
+        _pushes++;
+        _deferStreak = 0;
+    }
+    _frameTimeSum += frameTime;
+    _maxFrameTime = min((uint32_t)0xFFFF, max((uint32_t)_maxFrameTime, frameTime));
+}
+
+uint32_t FrameScheduler::getFrames() const { return _frames; }
+
+uint32_t FrameScheduler::getPushes() const { return _pushes; }
+
+uint32_t FrameScheduler::getLateFrames() const { return _lateFrames; }
+
+uint32_t FrameScheduler::getDeferredFrames() const { return _deferredFrames; }
+
+uint16_t FrameScheduler::getMaxFrameTime() const { return _maxFrameTime; }
+
+uint16_t FrameScheduler::getAvgFrameTime() const { return _frames ? _frameTimeSum / _frames : 0; }
+
+uint16_t FrameScheduler::getMaxLateness() const { return _maxLateness; }
+
+void FrameScheduler::printStats(Stream &out)
+{
+    out.print("Frames : ");
+    out.print(_frames);
+    out.print("  pushes : ");
+    out.print(_pushes);
+    out.print("  late : ");
+    out.print(_lateFrames);
+    out.print("  deferred : ");
+    out.print(_deferredFrames);
+    out.print("  frame time avg/max : ");
+    out.print(getAvgFrameTime());
+    out.print("/");
+    out.print(_maxFrameTime);
+    out.print(" us  max tick delay : ");
+    out.print(_maxLateness);
+    out.println(" us");
+}
+
+void FrameScheduler::resetStats()
+{
+    _frames = 0;
+    _pushes = 0;
+    _lateFrames = 0;
+    _deferredFrames = 0;
+    _frameTimeSum = 0;
+    _maxFrameTime = 0;
+    _maxLateness = 0;
+}
+
+/*************************************************************************************************************/
+/*                         LEDs chain framebuffer                                                            */
+/*************************************************************************************************************/
+
+LedsChain::LedsChain(uint16_t numPixels, int16_t pin, neoPixelType type, uint8_t *frame, uint8_t *wire, uint8_t *dirty)
+    : Adafruit_NeoPixel(),
+      _frame(frame),
+      _dirty(dirty),
+      _anyDirty(false),
+      _globalBrightness(255),
+      _lastPushPixels(0)
+{
+    // The wire buffer is provided by the sized chain instead of being allocated by Adafruit_NeoPixel.
+    // Color offsets set here as in Adafruit_NeoPixel::updateType(), which would link its allocating updateLength()
+    wOffset = (type >> 6) & 0b11;
+    rOffset = (type >> 4) & 0b11;
+    gOffset = (type >> 2) & 0b11;
+    bOffset = type & 0b11;
+#ifdef NEO_KHZ400
+    is800KHz = (type < 256);
+#endif
+    setPin(pin);
+    pixels = wire;
+    numLEDs = numPixels;
+    numBytes = numPixels * 3;
+}
+
+bool LedsChain::setColor(uint16_t pixel, uint8_t red, uint8_t green, uint8_t blue)
+{
+    if (pixel >= numLEDs)
+        return false;
+
+    uint8_t *p = &_frame[pixel * 3];
+    if (p[0] == red && p[1] == green && p[2] == blue)
+        return false;
+
+    p[0] = red;
+    p[1] = green;
+    p[2] = blue;
+    _dirty[pixel >> 3] |= 1 << (pixel & 0x07);
+    _anyDirty = true;
+    return true;
+}
+
+void LedsChain::getColor(uint16_t pixel, uint8_t &red, uint8_t &green, uint8_t &blue) const
+{
+    if (pixel >= numLEDs)
+    {
+        red = green = blue = 0;
+        return;
+    }
+
+    const uint8_t *p = &_frame[pixel * 3];
+    red = p[0];
+    green = p[1];
+    blue = p[2];
+}
+
+void LedsChain::clear()
+{
+    memset(_frame, 0, numLEDs * 3);
+    _markAllDirty();
+}
+
+void LedsChain::setBrightness(uint8_t brightness)
+{
+    // Non destructive : the framebuffer keeps full scale colors, all pixels are encoded again
+    if (brightness == _globalBrightness)
+        return;
+
+    _globalBrightness = brightness;
+    _markAllDirty();
+}
+
+uint8_t LedsChain::getBrightness() const { return _globalBrightness; }
+
+bool LedsChain::isDirty() const { return _anyDirty; }
+
+uint16_t LedsChain::getLastPushPixels() const { return _lastPushPixels; }
+
+bool LedsChain::show()
+{
+    if (!_anyDirty)
+        return false;
+
+    // Encode only the dirty pixels to the wire buffer, empty bitmap bytes are skipped
+    uint16_t lastDirty = 0;
+    for (uint8_t i = 0; i < (numLEDs + 7) / 8; i++)
+    {
+        uint8_t bits = _dirty[i];
+        for (uint16_t pixel = i * 8; bits; pixel++, bits >>= 1)
+        {
+            if (bits & 0x01)
+            {
+                _encode(pixel);
+                lastDirty = pixel;
+            }
+        }
+        _dirty[i] = 0;
+    }
+    _anyDirty = false;
+
+    // Clock out the chain only up to the last changed pixel, the pixels after keep their latched colors
+    _lastPushPixels = lastDirty + 1;
+    uint16_t fullBytes = numBytes;
+    numBytes = _lastPushPixels * 3;
+    Adafruit_NeoPixel::show();
+    numBytes = fullBytes;
+    return true;
+}
+
+void LedsChain::_markAllDirty()
+{
+    memset(_dirty, 0xFF, (numLEDs + 7) / 8);
+    // Bits past the last pixel are never encoded
+    if (numLEDs & 0x07)
+        _dirty[numLEDs / 8] = (1 << (numLEDs & 0x07)) - 1;
+    _anyDirty = true;
+}
+
+void LedsChain::_encode(uint16_t pixel)
+{
+    const uint8_t *src = &_frame[pixel * 3];
+    uint8_t *dst = &pixels[pixel * 3];
+
+    if (_globalBrightness == 255)
+    {
+        dst[rOffset] = src[0];
+        dst[gOffset] = src[1];
+        dst[bOffset] = src[2];
+    }
+    else
+    {
+        uint16_t scale = _globalBrightness + 1;
+        dst[rOffset] = (src[0] * scale) >> 8;
+        dst[gOffset] = (src[1] * scale) >> 8;
+        dst[bOffset] = (src[2] * scale) >> 8;
+    }
+}
+
+/*************************************************************************************************************/
+/*                         Fixed point ramp                                                                  */
+/*************************************************************************************************************/
+
+LedsRamp::LedsRamp()
+    : _value(0), _slope(0), _frameSlope(0),
+      _endTime(0), _lastTime(0),
+      _target(0), _frameTime(0), _done(true)
+{
+}
+
+void LedsRamp::init(uint16_t from, uint16_t to, uint16_t rampTime, uint32_t startTime, uint8_t frameTime)
+{
+    _target = to;
+    _done = (from == to || rampTime == 0);
+    _value = (int32_t)(_done ? to : from) * 65536L;
+    if (_done)
+        return;
+
+    _slope = ((int32_t)to - (int32_t)from) * 65536L / rampTime;
+    _frameSlope = _slope * frameTime;
+    _frameTime = frameTime;
+    _lastTime = startTime;
+    _endTime = startTime + rampTime;
+}
+
+uint16_t LedsRamp::step(uint32_t currentTime)
+{
+    if (_done)
+        return _target;
+
+    // Land on the target at the ramp end, even if the last frames were skipped
+    if ((int32_t)(currentTime - _endTime) >= 0)
+    {
+        _done = true;
+        _value = (int32_t)_target * 65536L;
+        return _target;
+    }
+
+    uint32_t deltaTime = currentTime - _lastTime;
+    _lastTime = currentTime;
+    _value += (deltaTime == _frameTime) ? _frameSlope : _slope * (int32_t)deltaTime;
+
+    return getValue();
+}
+
+uint16_t LedsRamp::getValue() const { return (_value + 0x8000) >> 16; }
+
+bool LedsRamp::isDone() const { return _done; }
+
+/*************************************************************************************************************/
+/*                         LEDs strip engines base                                                           */
+/*************************************************************************************************************/
+
+LedsStrip::LedsStrip(LedsChain *strip)
     : _strip(strip),
       _updateRequired(true),
       _currentTime(0), 
@@ -48,7 +352,7 @@ bool LedsStrip::update(uint32_t syncCurrentTime)
     if (!_updateRequired)
         return false;
 
-    _strip->show();
+    // The chain is pushed once for all engines by the caller, see LedsChain::show()
     // Reset update tracker
     _updateRequired = false;
     return true;
@@ -72,46 +376,12 @@ void LedsStrip::_setColorAll(uint8_t start, uint8_t end, uint8_t red, uint8_t gr
 
 void LedsStrip::_setColor(uint8_t pixel, uint8_t red, uint8_t green, uint8_t blue)
 {
-    if (pixel >= _strip->numPixels())
-        return;
-
-    // Extract the individual color components from the packed value
-    uint8_t currentRed, currentGreen, currentBlue;
-    _getCurrentColor(pixel, currentRed, currentGreen, currentBlue);
-
-    // Check if the current color is different from the new one
-    if (currentRed != red || currentGreen != green || currentBlue != blue)
-    {
-        // If the color is different, set the new color
-        _strip->setPixelColor(pixel, red, green, blue);
-
-        // Mark that an update is needed
+    // Mark that an update is needed if the color is different from the framebuffer one
+    if (_strip->setColor(pixel, red, green, blue))
         _updateRequired = true;
-    }
-}
-
-uint16_t LedsStrip::_rampParameter(uint32_t iniTime, uint16_t rampTime, uint16_t iniPara, uint16_t tgPara, uint16_t updateSpeed)
-{
-    // No ramping needed if the values are the same
-    if (iniPara == tgPara)
-        return iniPara;
-
-    // Ensure rampDuration is at least 1 to avoid division by zero
-    // And apply a small offset to make sure ramp is done before rampTime...
-    uint16_t correctedRampTime = max(5, rampTime - (updateSpeed * 2));
-
-    // Map the timeElapsed to the new value and constrain to prevent overshooting
-    uint16_t mappedValue = constrain(map(_currentTime - iniTime, 0, correctedRampTime, iniPara, tgPara),
-                                     min(iniPara, tgPara),
-                                     max(iniPara, tgPara));
-
-    return mappedValue;
 }
 
 void LedsStrip::_getCurrentColor(uint8_t pixel, uint8_t &red, uint8_t &green, uint8_t &blue)
 {
-    uint32_t color = _strip->getPixelColor(pixel);
-    red = (color >> 16) & 0xFF;
-    green = (color >> 8) & 0xFF;
-    blue = color & 0xFF;
+    _strip->getColor(pixel, red, green, blue);
 }
\ No newline at end of file
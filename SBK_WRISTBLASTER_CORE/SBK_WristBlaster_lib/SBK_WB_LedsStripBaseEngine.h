@@ -49,10 +49,131 @@ const uint8_t ORANGE[3] = {255, 100, 0};
 const uint8_t COOL_BLUE[3] = {50, 50, 255};
 const uint8_t BLACK[3] = {0, 0, 0};
 
+/*************************************************************************************************************/
+/*   WS2812 chain with its own RGB framebuffer : engines write full scale colors and read them back without  */
+/*   loss, changed pixels are flagged in a dirty bitmap and encoded to the NeoPixel wire buffer with the     */
+/*   global brightness only at show() time. Three bytes per pixel types only (NEO_GRB, NEO_RGB...).          */
+/*   show() only clocks out the chain up to the last changed pixel, the following pixels keep their colors.  */
+/*   The NeoPixel base is private : its pixel writes would bypass the framebuffer and be overwritten.        */
+/*************************************************************************************************************/
+
+// WS2812 push time in us, interrupts masked, for a chain clocked out up to a pixels count : 24 bits at 800kHz per pixel
+#define WS2812_PUSH_US(pixels) ((uint16_t)(pixels) * 30)
+
+class LedsChain : private Adafruit_NeoPixel
+{
+public:
+    LedsChain(uint16_t numPixels, int16_t pin, neoPixelType type, uint8_t *frame, uint8_t *wire, uint8_t *dirty);
+
+    using Adafruit_NeoPixel::begin;
+    using Adafruit_NeoPixel::numPixels;
+
+    bool setColor(uint16_t pixel, uint8_t red, uint8_t green, uint8_t blue);
+    void getColor(uint16_t pixel, uint8_t &red, uint8_t &green, uint8_t &blue) const;
+    void clear();
+    void setBrightness(uint8_t brightness);
+    uint8_t getBrightness() const;
+    bool isDirty() const;
+    bool show();
+    uint16_t getLastPushPixels() const;
+
+private:
+    uint8_t *_frame;           // Full scale RGB colors, 3 bytes per pixel
+    uint8_t *_dirty;           // One bit per pixel changed since last show
+    bool _anyDirty;            // At least one dirty pixel
+    uint8_t _globalBrightness; // Applied at encode time, 255 is full scale
+    uint16_t _lastPushPixels;  // Pixels clocked out by the last show
+
+    void _markAllDirty();
+    void _encode(uint16_t pixel);
+};
+
+template <uint16_t PIXELS>
+class WS2812Chain : public LedsChain
+{
+public:
+    WS2812Chain(int16_t pin, neoPixelType type = NEO_GRB + NEO_KHZ800)
+        : LedsChain(PIXELS, pin, type, _frameStorage, _wireStorage, _dirtyStorage),
+          _frameStorage{0}, _wireStorage{0}, _dirtyStorage{0}
+    {
+    }
+
+private:
+    uint8_t _frameStorage[PIXELS * 3];
+    uint8_t _wireStorage[PIXELS * 3];
+    uint8_t _dirtyStorage[(PIXELS + 7) / 8];
+};
+
+/*************************************************************************************************************/
+/*   Frame scheduler : fixed rate render tick for the WS2812 chain. Engines clocks are only advanced on the  */
+/*   tick so their animations step at most once per frame, and the chain is pushed at most once per frame.  */
+/*   A push can be deferred a few frames while another interrupt sensitive transfer is running (audio       */
+/*   player serial). Frame statistics are in micro seconds, the frame time being the update and push time.  */
+/*************************************************************************************************************/
+
+class FrameScheduler
+{
+public:
+    FrameScheduler(uint16_t frameRate, uint8_t maxDeferredFrames);
+    void begin();
+    bool tick();
+    bool defer();
+    void frameDone(bool pushed);
+    uint32_t getFrames() const;
+    uint32_t getPushes() const;
+    uint32_t getLateFrames() const;
+    uint32_t getDeferredFrames() const;
+    uint16_t getMaxFrameTime() const;
+    uint16_t getAvgFrameTime() const;
+    uint16_t getMaxLateness() const;
+    void printStats(Stream &out);
+    void resetStats();
+
+private:
+    const uint32_t _FRAME_PERIOD; // us
+    const uint8_t _MAX_DEFERRED;  // Consecutive deferred pushes allowed before forcing one
+    uint8_t _deferStreak;
+    uint32_t _nextFrame;          // Next tick deadline, ticks stay on a fixed grid unless a whole frame is missed
+    uint32_t _frameStart;
+    uint32_t _frames;
+    uint32_t _pushes;
+    uint32_t _lateFrames;         // Ticks missed by a whole period or more, the grid is restarted
+    uint32_t _deferredFrames;
+    uint32_t _frameTimeSum;
+    uint16_t _maxFrameTime;
+    uint16_t _maxLateness;        // Worst tick delay after its deadline
+};
+
+/*************************************************************************************************************/
+/*   Linear ramp in Q16.16 fixed point, for values up to 32767 : the slope is computed once at init, a       */
+/*   regular frame steps with a single add, a late frame with one multiply, and the target is reached        */
+/*   exactly at the ramp end time whatever frames were skipped.                                              */
+/*************************************************************************************************************/
+
+class LedsRamp
+{
+public:
+    LedsRamp();
+    void init(uint16_t from, uint16_t to, uint16_t rampTime, uint32_t startTime, uint8_t frameTime);
+    uint16_t step(uint32_t currentTime);
+    uint16_t getValue() const;
+    bool isDone() const;
+
+private:
+    int32_t _value;      // Q16.16
+    int32_t _slope;      // Q16.16 change per ms
+    int32_t _frameSlope; // Q16.16 change per regular frame
+    uint32_t _endTime;
+    uint32_t _lastTime;
+    uint16_t _target;
+    uint8_t _frameTime;
+    bool _done;
+};
+
 class LedsStrip
 {
 public:
-    LedsStrip(Adafruit_NeoPixel *strip);
+    LedsStrip(LedsChain *strip);
     virtual ~LedsStrip() = default;
 
     bool update();
@@ -61,13 +182,12 @@ public:
 protected:
     void _setColorAll(uint8_t start, uint8_t end, uint8_t red, uint8_t green, uint8_t blue);
     void _setColor(uint8_t pixel, uint8_t red, uint8_t green, uint8_t blue);
-    uint16_t _rampParameter(uint32_t iniTime, uint16_t rampTime, uint16_t iniPara, uint16_t tgPara, uint16_t updateSpeed);
     void _getCurrentColor(uint8_t pixel, uint8_t &red, uint8_t &green, uint8_t &blue);
     void _clearStrip();
     void _clearPixel(uint8_t pixel);
     void _clearSomePixels(uint8_t start, uint8_t end);
 
-    Adafruit_NeoPixel *_strip; // Pointer to shared NeoPixel instance
+    LedsChain *_strip; // Pointer to shared LEDs chain instance
     bool _updateRequired;
     uint32_t _currentTime;
     uint32_t _prevUpdate;
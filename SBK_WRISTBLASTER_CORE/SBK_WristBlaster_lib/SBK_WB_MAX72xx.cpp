@@ -32,19 +32,26 @@
  #define OP_SHUTDOWN    12
  #define OP_DISPLAYTEST 15
  
- MAX72xx::MAX72xx(int dataPin, int clkPin, int csPin, int numDevices) {
+ // Hardware SPI clock, MAX72xx accepts up to 10MHz
+ #define MAX72xx_SPI_CLOCK 8000000
+ 
+ MAX72xx::MAX72xx(int dataPin, int clkPin, int csPin, int numDevices, MAX72xxTransport transportType) {
      SPI_MOSI = dataPin;
      SPI_CLK  = clkPin;
      SPI_CS   = csPin;
-     maxDevices = (numDevices > 0 && numDevices <= 8) ? numDevices : 8;
+     maxDevices = (numDevices > 0 && numDevices <= MAX72xx_MAX_DEVICES) ? numDevices : MAX72xx_MAX_DEVICES;
+     transferCount = 0;
  
      pinMode(SPI_MOSI, OUTPUT);
      pinMode(SPI_CLK, OUTPUT);
      pinMode(SPI_CS, OUTPUT);
      digitalWrite(SPI_CS, HIGH);
+     // Bit-bang until begin(), SPI must not be started during static initialization
+     transport = MAX72xx_BITBANG;
+     requestedTransport = transportType;
  
      // Initialize all devices
-     for (int i = 0; i < 8; i++) {
+     for (int i = 0; i < MAX72xx_MAX_DEVICES * 8; i++) {
          status[i] = 0x00;
      }
      for (int i = 0; i < maxDevices; i++) {
@@ -56,6 +63,56 @@
      }
  }
  
+ void MAX72xx::begin() {
+     setTransport(requestedTransport);
+ }
+ 
+ MAX72xxTransport MAX72xx::setTransport(MAX72xxTransport newTransport) {
+     // Hardware SPI can only be used if the driver is wired to the SPI bus pins
+     if (newTransport == MAX72xx_HW_SPI && (SPI_MOSI != MOSI || SPI_CLK != SCK)) {
+         newTransport = MAX72xx_FAST_GPIO;
+     }
+ 
+     if (transport == MAX72xx_HW_SPI && newTransport != MAX72xx_HW_SPI) {
+         SPI.end();
+         pinMode(SPI_MOSI, OUTPUT);
+         pinMode(SPI_CLK, OUTPUT);
+     }
+ 
+     if (newTransport == MAX72xx_HW_SPI) {
+         SPI.begin();
+     }
+     else if (newTransport == MAX72xx_FAST_GPIO) {
+         dataReg = portOutputRegister(digitalPinToPort(SPI_MOSI));
+         clkReg = portOutputRegister(digitalPinToPort(SPI_CLK));
+         csReg = portOutputRegister(digitalPinToPort(SPI_CS));
+         dataMask = digitalPinToBitMask(SPI_MOSI);
+         clkMask = digitalPinToBitMask(SPI_CLK);
+         csMask = digitalPinToBitMask(SPI_CS);
+         *clkReg &= ~clkMask;
+     }
+ 
+     transport = newTransport;
+     return transport;
+ }
+ 
+ MAX72xxTransport MAX72xx::getTransport() {
+     return transport;
+ }
+ 
+ float MAX72xx::benchmarkRowWrite(int addr, uint16_t iterations) {
+     if (addr < 0 || addr >= maxDevices || iterations == 0) return 0;
+ 
+     // Rewrite the rows with their actual values so the display is not disturbed
+     uint32_t start = micros();
+     for (uint16_t i = 0; i < iterations; i++) {
+         spiTransfer(addr, (i & 0x07) + 1, status[addr * 8 + (i & 0x07)]);
+     }
+     uint32_t elapsed = micros() - start;
+ 
+     return (float)elapsed / iterations;
+ }
+ 
  int MAX72xx::getDeviceCount() {
      return maxDevices;
  }
@@ -81,8 +138,9 @@
  void MAX72xx::clearDisplay(int addr) {
      if (addr < 0 || addr >= maxDevices) return;
  
+     int offset = addr * 8;
      for (int i = 0; i < 8; i++) {
-         status[i] = 0;
+         status[offset + i] = 0;
          spiTransfer(addr, i + 1, 0);
      }
  }
@@ -90,22 +148,80 @@
  void MAX72xx::setLed(int addr, int row, int col, boolean state) {
      if (addr < 0 || addr >= maxDevices || row < 0 || row > 7 || col < 0 || col > 7) return;
  
+     int offset = addr * 8;
      byte mask = B10000000 >> col;
      if (state) {
-         status[row] |= mask;
+         status[offset + row] |= mask;
      } else {
-         status[row] &= ~mask;
+         status[offset + row] &= ~mask;
      }
-     spiTransfer(addr, row + 1, status[row]);
+     spiTransfer(addr, row + 1, status[offset + row]);
  }
  
  void MAX72xx::setRow(int addr, int row, byte value) {
      if (addr < 0 || addr >= maxDevices || row < 0 || row > 7) return;
  
-     status[row] = value;
+     status[addr * 8 + row] = value;
      spiTransfer(addr, row + 1, value);
  }
  
+ uint8_t MAX72xx::updateRows(int addr, const byte *rows, int numRows) {
+     if (addr < 0 || addr >= maxDevices) return 0;
+ 
+     int offset = addr * 8;
+     uint8_t sent = 0;
+     numRows = min(numRows, 8);
+     for (int row = 0; row < numRows; row++) {
+         // Only rows that changed since last transfer are sent to the chip
+         if (rows[row] != status[offset + row]) {
+             status[offset + row] = rows[row];
+             spiTransfer(addr, row + 1, rows[row]);
+             sent++;
+         }
+     }
+     return sent;
+ }
+ 
+ uint8_t MAX72xx::updateChain(const byte *rows) {
+     uint8_t sent = 0;
+     for (int row = 0; row < 8; row++) {
+         // One frame per row : the devices where this row changed get it, the others a no-op
+         bool changed = false;
+         for (int addr = 0; addr < maxDevices; addr++) {
+             int offset = addr * 2;
+             byte value = rows[addr * 8 + row];
+             if (value != status[addr * 8 + row]) {
+                 status[addr * 8 + row] = value;
+                 spidata[offset + 1] = row + 1;
+                 spidata[offset] = value;
+                 changed = true;
+             } else {
+                 spidata[offset + 1] = OP_NOOP;
+                 spidata[offset] = 0;
+             }
+         }
+         if (changed) {
+             spiFlush();
+             sent++;
+         }
+     }
+     return sent;
+ }
+ 
+ byte MAX72xx::getRow(int addr, int row) {
+     if (addr < 0 || addr >= maxDevices || row < 0 || row > 7) return 0;
+ 
+     return status[addr * 8 + row];
+ }
+ 
+ uint16_t MAX72xx::getTransferCount() {
+     return transferCount;
+ }
+ 
+ void MAX72xx::resetTransferCount() {
+     transferCount = 0;
+ }
+ 
  void MAX72xx::setColumn(int addr, int col, byte value) {
      if (addr < 0 || addr >= maxDevices || col < 0 || col > 7) return;
  
@@ -117,9 +233,65 @@
  void MAX72xx::spiTransfer(int addr, volatile byte opcode, volatile byte data) {
      if (addr < 0 || addr >= maxDevices) return;
  
-     digitalWrite(SPI_CS, LOW);
-     shiftOut(SPI_MOSI, SPI_CLK, MSBFIRST, opcode);
-     shiftOut(SPI_MOSI, SPI_CLK, MSBFIRST, data);
-     digitalWrite(SPI_CS, HIGH);
+     // The command goes to this device only, the other devices of the chain get a no-op
+     int offset = addr * 2;
+     for (int i = 0; i < maxDevices * 2; i++) {
+         spidata[i] = 0;
+     }
+     spidata[offset + 1] = opcode;
+     spidata[offset] = data;
+     spiFlush();
+ }
+ 
+ void MAX72xx::spiFlush() {
+     // The first bytes shifted out end up in the last device of the chain, all devices latch on CS rising edge
+     int maxbytes = maxDevices * 2;
+ 
+     switch (transport) {
+     case MAX72xx_HW_SPI:
+         SPI.beginTransaction(SPISettings(MAX72xx_SPI_CLOCK, MSBFIRST, SPI_MODE0));
+         digitalWrite(SPI_CS, LOW);
+         for (int i = maxbytes; i > 0; i--) {
+             SPI.transfer(spidata[i - 1]);
+         }
+         digitalWrite(SPI_CS, HIGH);
+         SPI.endTransaction();
+         break;
+ 
+     case MAX72xx_FAST_GPIO: {
+         // Ports registers are shared with other pins : no interrupt while read-modify-write
+         uint8_t oldSREG = SREG;
+         cli();
+         *csReg &= ~csMask;
+         for (int i = maxbytes; i > 0; i--) {
+             fastShiftOut(spidata[i - 1]);
+         }
+         *csReg |= csMask;
+         SREG = oldSREG;
+         break;
+     }
+ 
+     default:
+         digitalWrite(SPI_CS, LOW);
+         for (int i = maxbytes; i > 0; i--) {
+             shiftOut(SPI_MOSI, SPI_CLK, MSBFIRST, spidata[i - 1]);
+         }
+         digitalWrite(SPI_CS, HIGH);
+         break;
+     }
+     transferCount++;
+ }
+ 
+ void MAX72xx::fastShiftOut(byte value) {
+     for (uint8_t mask = 0x80; mask; mask >>= 1) {
+         if (value & mask) {
+             *dataReg |= dataMask;
+         } else {
+             *dataReg &= ~dataMask;
+         }
+         // Data is latched on clock rising edge
+         *clkReg |= clkMask;
+         *clkReg &= ~clkMask;
+     }
  }
  
\ No newline at end of file
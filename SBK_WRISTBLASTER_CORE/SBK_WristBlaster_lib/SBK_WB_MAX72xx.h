@@ -19,14 +19,25 @@
  
  #include <Arduino.h>
  #include <avr/pgmspace.h>
+ #include <SPI.h>
  
+ /* Serial transport used to shift commands out to the MAX72xx */
+ enum MAX72xxTransport {
+     MAX72xx_BITBANG,    // Arduino shiftOut()/digitalWrite(), any pins (original behaviour)
+     MAX72xx_FAST_GPIO,  // Direct port register writes, any pins
+     MAX72xx_HW_SPI      // Hardware SPI peripheral, data on MOSI and clock on SCK pins only
+ };
+ 
+ /* Maximum number of daisy chained devices */
+ #define MAX72xx_MAX_DEVICES 8
+
  class MAX72xx {
      private:
-         /* Buffer for SPI data */
-         byte spidata[4];   // Reduced from 16 to 4 (enough for 1 command)
+         /* Buffer for SPI data : one opcode/data pair per device of the chain */
+         byte spidata[MAX72xx_MAX_DEVICES * 2];
          
-         /* LED status array (for a single 8x8 display) */
-         byte status[8];    // Reduced from 64 to 8 (assuming 1 device)
+         /* LED status array : 8 rows per device, as last sent */
+         byte status[MAX72xx_MAX_DEVICES * 8];
  
          /* SPI pin configuration */
          int SPI_MOSI;
@@ -36,12 +47,41 @@
          /* Number of connected MAX72xx devices */
          int maxDevices;
  
-         /* Send out a single command to the device */
+         /* Number of SPI transactions sent since last reset */
+         uint16_t transferCount;
+ 
+         /* Active transport and cached port registers for the fast GPIO transport */
+         MAX72xxTransport transport;
+         MAX72xxTransport requestedTransport;
+         volatile uint8_t *dataReg;
+         volatile uint8_t *clkReg;
+         volatile uint8_t *csReg;
+         uint8_t dataMask;
+         uint8_t clkMask;
+         uint8_t csMask;
+ 
+         /* Send out a single command to the device, other devices of the chain get a no-op */
          void spiTransfer(int addr, byte opcode, byte data);
+
+         /* Shift the whole spidata buffer out to the chain within one CS frame */
+         void spiFlush();
+ 
+         /* Shift out one byte with the fast GPIO transport */
+         void fastShiftOut(byte value);
  
      public:
          /* Constructor */
-         MAX72xx(int dataPin, int clkPin, int csPin, int numDevices = 1);
+         MAX72xx(int dataPin, int clkPin, int csPin, int numDevices = 1, MAX72xxTransport transport = MAX72xx_BITBANG);
+ 
+         /* Apply the transport requested in the constructor, call it from setup() */
+         void begin();
+ 
+         /* Select the serial transport, returns the transport really in use */
+         MAX72xxTransport setTransport(MAX72xxTransport newTransport);
+         MAX72xxTransport getTransport();
+ 
+         /* Time row writes with the active transport, returns microseconds per row write */
+         float benchmarkRowWrite(int addr, uint16_t iterations);
  
          /* Get number of devices */
          int getDeviceCount();
@@ -66,6 +106,20 @@
  
          /* Set an entire column */
          void setColumn(int addr, int col, byte value);
+
+         /* Send only the rows that differ from the last values sent, returns rows sent */
+         uint8_t updateRows(int addr, const byte *rows, int numRows);
+
+         /* Same for the whole chain, rows[addr * 8 + row] : each row that changed on any device
+            is sent to all devices in one CS frame (no-op for unchanged devices), returns frames sent */
+         uint8_t updateChain(const byte *rows);
+
+         /* Get the last value sent to a row */
+         byte getRow(int addr, int row);
+
+         /* SPI transactions counter */
+         uint16_t getTransferCount();
+         void resetTransferCount();
  };
  
  #endif  // MAX72xx_H
\ No newline at end of file
@@ -31,13 +31,40 @@
 /*       (with DFPlayerMini_Fast.h library)       */
 /////////////////////////////////////////////////////
 
+// BUSY pin last edge, written by the pin change interrupt
+static uint8_t _busyPinNumber = 0;
+static volatile bool _busyRawLevel = HIGH;
+static volatile uint32_t _busyEdgeTime = 0;
+static volatile uint8_t _busyEdgeCount = 0;
+
+// Commands starting, changing or stopping the track
+static bool _isTrackCommand(uint8_t cmd)
+{
+  return cmd == DFP_CMD_PLAY || cmd == DFP_CMD_LOOP || cmd == DFP_CMD_STOP ||
+         cmd == DFP_CMD_PAUSE || cmd == DFP_CMD_NEXT || cmd == DFP_CMD_PREVIOUS;
+}
+
+// Track commands leading to a playing track
+static bool _isPlayCommand(uint8_t cmd)
+{
+  return cmd == DFP_CMD_PLAY || cmd == DFP_CMD_LOOP || cmd == DFP_CMD_NEXT || cmd == DFP_CMD_PREVIOUS;
+}
+
+static void _busyPinChange()
+{
+  _busyRawLevel = digitalRead(_busyPinNumber);
+  _busyEdgeTime = millis();
+  _busyEdgeCount++;
+}
+
 Player::Player(const uint8_t MAX, uint8_t volume,
                const uint8_t RX_pin, const uint8_t TX_pin,
                const uint8_t BUSY_pin, const uint8_t amp_MUTE_pin,
                const uint8_t pot_pin, const bool volPotEnable,
                const uint8_t commandDelay,
                const uint8_t audioAdvance,
-               const bool busyPinEnable)
+               const bool busyPinEnable,
+               const uint8_t replyWindow)
     : _VOLUME_MAX(constrain(MAX, 0, 30)),
       _volume(volume),
       _RX_PIN(RX_pin),
@@ -49,6 +76,9 @@ Player::Player(const uint8_t MAX, uint8_t volume,
       _COMMAND_DELAY(commandDelay),
       _AUDIO_ADVANCE(audioAdvance),
       _BUSY_PIN_ENABLE(busyPinEnable),
+      _REPLY_WINDOW(replyWindow),
+      _serial(nullptr), _hardwareSerial(false),
+      _ackPacing(false), _ackPending(false), _ackTimeouts(0), _maxAckTime(0),
       _currentTime(0),
       _startTime(0),
       _startTimePrev(0),
@@ -57,34 +87,49 @@ Player::Player(const uint8_t MAX, uint8_t volume,
       _playing(false),
       _prevAnalogRead(0),
       _lastCommand(0),
+      _lastCmd(0), _lastCmdParam(0), _lastCmdDuration(0), _lastCmdRetried(true),
+      _rxFrame{0}, _rxIndex(0), _rxLastByte(0),
+      _rxFrames(0), _rxCorrupted(0), _retries(0),
+      _queue{}, _queueCount(0), _trackPending(false), _playPending(false), _trackCommandTime(0), _pendingTrackDuration(0),
+      _coalesced(0), _dropped(0), _maxQueueDelay(0),
+      _bootStep(PLAYER_BOOT_DONE), _beginTime(0), _readyTime(0),
+      _commandsSent(0), _commandTimeSum(0), _maxCommandTime(0),
+      _busyLevel(HIGH), _busyStarted(false), _busyStartTime(0), _busyEndTime(0),
+      _busyEdges(0), _busyGlitches(0), _lastTrackLength(0), _trackLengthMeasured(false),
       _mute(true)
 {
 }
 
-bool Player::begin(Stream &s)
+// hardwareSerial tells the stream is a hardware USART (Serial1...) : its reception goes on while interrupts are masked
+// ackPacing sends the commands with feedback and releases the next one on the module acknowledge,
+// the command delay is then only the timeout of a lost acknowledge
+bool Player::begin(Stream &s, bool hardwareSerial, bool ackPacing)
 {
   pinMode(_BUSY_PIN, INPUT);
   muteAmp(true);
 
+  if (_BUSY_PIN_ENABLE)
+  {
+    _busyPinNumber = _BUSY_PIN;
+    _busyRawLevel = digitalRead(_BUSY_PIN);
+    _busyLevel = _busyRawLevel;
+    attachInterrupt(digitalPinToInterrupt(_BUSY_PIN), _busyPinChange, CHANGE);
+  }
+
   if (_VOL_POT_ENABLE)
     pinMode(_POT_PIN, INPUT);
 
+  _serial = &s;
+  _hardwareSerial = hardwareSerial;
+  _ackPacing = ackPacing;
+
   if (_player.begin(s, false, 50))
   {
-    delay(_COMMAND_DELAY);
-    setVol(_volume);
-    delay(_COMMAND_DELAY);
-    _player.playbackSource(2);
-    delay(_COMMAND_DELAY);
-    _player.EQSelect(1);
-    delay(_COMMAND_DELAY);
-    _player.stop();
-    delay(_COMMAND_DELAY);
-    _player.startDAC();
-    delay(_COMMAND_DELAY);
-    _player.stopRepeat();
-    delay(_COMMAND_DELAY);
-    _lastCommand = _currentTime; // Note when player's command is passed for delay check
+    // The setup commands are sent from update(), one per command delay, the first one after a delay for the module start
+    _beginTime = millis();
+    _currentTime = _beginTime;
+    _lastCommand = _beginTime;
+    _bootStep = 0;
     return true;
   }
   else
@@ -93,11 +138,26 @@ bool Player::begin(Stream &s)
   }
 }
 
+// True once the boot sequence is done, queued commands are held until then
+bool Player::isReady() const { return _bootStep == PLAYER_BOOT_DONE; }
+
+uint32_t Player::getReadyTime() const { return _readyTime; }
+
 void Player::update() { update(millis()); }
 
 void Player::update(uint32_t syncCurrentTime)
 {
   _currentTime = syncCurrentTime;
+
+  _readReplies();
+
+  if (_BUSY_PIN_ENABLE)
+    _updateBusy();
+
+  if (_bootStep != PLAYER_BOOT_DONE)
+    _processBoot();
+  else
+    _processQueue();
 }
 
 uint8_t Player::setVolWithPotAtStart()
@@ -114,11 +174,7 @@ uint8_t Player::setVolWithPotAtStart()
     if (newVolume != _volume)
     {
       _volume = newVolume;
-      _player.volume(newVolume);
-
-      _lastCommand = _currentTime; // Note when player's command is passed for delay check
-
-      _volumeAmpMute(); // Mute amp if volume is zero
+      _queueCommand(DFP_CMD_VOLUME, newVolume);
     }
   }
 
@@ -149,11 +205,7 @@ uint8_t Player::setVolWithPot()
         if (newVolume != _volume)
         {
           _volume = newVolume;
-          _player.volume(newVolume); // Apply volume change
-
-          _lastCommand = _currentTime; // Note when player's command is passed for delay check
-
-          _volumeAmpMute(); // Mute amp if volume is zero
+          _queueCommand(DFP_CMD_VOLUME, newVolume); // Apply volume change
         }
       }
     }
@@ -164,23 +216,23 @@ uint8_t Player::setVolWithPot()
 void Player::setVol(uint8_t volume)
 {
   _volume = constrain(volume, 0, _VOLUME_MAX);
-  _player.volume(_volume);
-  _lastCommand = _currentTime; // Note when player's command is passed for delay check
-
-  _volumeAmpMute(); // Temporary mute amp if volume is zero
+  _queueCommand(DFP_CMD_VOLUME, _volume);
 }
 
 bool Player::isPlaying()
 {
   bool playingNow = _playing;
 
-  if (_BUSY_PIN_ENABLE)
+  if (_trackPending)
+    playingNow = _playPending; // Track command waiting in the queue, a pending stop or pause reads as stopped
+  else if (_BUSY_PIN_ENABLE)
   {
-    // Use BUSY pin to determine play state
-    if (_currentTime - _startTime < 200)
-      playingNow = true; // Recently started, give it time to stabilize
+    // Use the filtered BUSY pin to determine play state, low means playing
+    if (!_busyStarted && _currentTime - _startTime < DFP_BUSY_START_TIMEOUT)
+      playingNow = true; // Recently started, BUSY not low yet
     else
-      playingNow = !digitalRead(_BUSY_PIN); // Low means playing, High means stopped
+      // Done at the predicted end, audio advance included, or at the real end if earlier
+      playingNow = _busyLevel == LOW && (_trackDuration == 0 || (int32_t)(_currentTime - _predictedEnd()) < 0);
   }
   else
     // Fallback: Check track duration if no BUSY pin
@@ -197,12 +249,75 @@ bool Player::isPlaying()
   return _playing;
 }
 
-bool Player::checkCommandDelay() { return (_currentTime - _lastCommand >= _COMMAND_DELAY); }
+// True while a track command waits in the queue, getTrackCommandTime() is the time it was sent once false
+bool Player::isTrackCommandPending() const { return _trackPending; }
+
+uint32_t Player::getTrackCommandTime() const { return _trackCommandTime; }
+
+// The serial line is quiet when no reply is expected from the last command and no reply frame is half received :
+// a WS2812 show masking interrupts at that time would corrupt the SoftwareSerial reception.
+// A hardware USART keeps receiving in its FIFO, up to 3 bytes or about 3 ms at 9600 bauds, longer than a short chain push.
+// Only a query : the replies are parsed in update(), unread bytes count as a reply being received.
+bool Player::isSerialQuiet() const
+{
+  if (_hardwareSerial)
+    return true;
+
+  bool replyExpected = _ackPacing ? _ackPending && (_currentTime - _lastCommand < _COMMAND_DELAY)
+                                  : (_currentTime - _lastCommand < _REPLY_WINDOW);
+
+  return !replyExpected && _rxIndex == 0 && !(_serial && _serial->available() > 0);
+}
+
+uint16_t Player::getReceivedFrames() const { return _rxFrames; }
+
+uint16_t Player::getCorruptedFrames() const { return _rxCorrupted; }
+
+uint16_t Player::getRetriedCommands() const { return _retries; }
+
+uint8_t Player::getQueuedCommands() const { return _queueCount; }
+
+uint16_t Player::getCoalescedCommands() const { return _coalesced; }
+
+uint16_t Player::getDroppedCommands() const { return _dropped; }
+
+uint16_t Player::getMaxQueueDelay() const { return _maxQueueDelay; }
+
+uint16_t Player::getMaxCommandTime() const { return _maxCommandTime; }
+
+uint16_t Player::getAvgCommandTime() const { return _commandsSent ? _commandTimeSum / _commandsSent : 0; }
+
+uint16_t Player::getAckTimeouts() const { return _ackTimeouts; }
+
+uint16_t Player::getMaxAckTime() const { return _maxAckTime; }
+
+// Time left before the playing track end minus the audio advance, when the next command should be sent :
+// 0 when not playing, 0xFFFFFFFF when looping or not sent yet. Counted from the BUSY falling edge when the BUSY pin is used.
+uint32_t Player::getTimeToEnd()
+{
+  if (!isPlaying())
+    return 0;
+
+  if (_trackPending || _trackDuration == 0)
+    return 0xFFFFFFFF;
+
+  int32_t timeLeft = _predictedEnd() - _currentTime;
+  return max((int32_t)0, timeLeft);
+}
+
+// Time of the last track end from the BUSY rising edge
+uint32_t Player::getTrackEndTime() const { return _busyEndTime; }
+
+uint16_t Player::getLastTrackLength() const { return _lastTrackLength; }
+
+// True once the end of the track started by the last track command was seen, its length is then getLastTrackLength()
+bool Player::isTrackLengthMeasured() const { return _trackLengthMeasured; }
+
+uint16_t Player::getBusyGlitches() const { return _busyGlitches; }
 
 void Player::setThemesPlaymode()
 {
-  _player.repeatFolder(1);
-  _lastCommand = _currentTime; // Note when player's command is passed for delay check
+  _queueCommand(DFP_CMD_REPEAT_FOLDER, 1);
 }
 
 void Player::setSinglePlaymode()
@@ -221,81 +336,411 @@ void Player::setCyclingTrackPlaymode()
 
 void Player::loopFileNum(int16_t track_num)
 {
-  muteAmp(false);
+  _queueCommand(DFP_CMD_LOOP, track_num);
+}
 
-  _player.loop(track_num);
-  _lastCommand = _currentTime; // Note when player's command is passed for delay check
+void Player::playFileNum(int16_t track_num, uint16_t track_length)
+{
+  uint32_t durationAfterAdvance = track_length - _AUDIO_ADVANCE;
+  uint32_t validDuration = max(0, durationAfterAdvance);      // Ensures non-negative value
+  _pendingTrackDuration = max(_COMMAND_DELAY, validDuration); // Ensures it's at least _COMMAND_DELAY
 
-  _startTime = _currentTime; // ???? NOT REQUIRED ????
-  _trackDuration = 0;        // No need for track duration since looping
+  _queueCommand(DFP_CMD_PLAY, track_num);
 }
 
-void Player::playFileNum(int16_t track_num, uint16_t track_length)
+void Player::stop() { _queueCommand(DFP_CMD_STOP, 0); }
+
+void Player::pause() { _queueCommand(DFP_CMD_PAUSE, 0); }
+
+void Player::next() { _queueCommand(DFP_CMD_NEXT, 0); }
+
+void Player::previous() { _queueCommand(DFP_CMD_PREVIOUS, 0); }
+
+void Player::muteAmp(bool enable) // Cute possible background noise and save power
 {
-  muteAmp(false);
+  if (_mute != enable)
+  {
+    _mute = enable;
+    _muteAmp(_mute); // Amp is muted when pin is High
+  }
+}
+
+void Player::_muteAmp(bool enable) { digitalWrite(_AMP_MUTE_PIN, enable); } // Amp is muted when pin is High
+
+void Player::_volumeAmpMute()
+{
+  if (_volume <= 1 && !_mute)
+  {
+    _muteAmp(true);
+  }
+  else if (_volume > 1 && !_mute)
+  {
+    _muteAmp(false);
+  }
+}
+
+// trackDuration is the playing time of a play command, kept with the command for a retry
+void Player::_sendCommand(uint8_t cmd, uint16_t param, uint32_t trackDuration)
+{
+  // CPU time of the command : the whole frame bit banged with SoftwareSerial, only buffered with a hardware USART
+  uint32_t sendStart = micros();
+
+  // Amp unmuted before a track starts and muted before it stops
+  if (cmd == DFP_CMD_NEXT || cmd == DFP_CMD_PREVIOUS || cmd == DFP_CMD_PLAY || cmd == DFP_CMD_LOOP)
+  {
+    muteAmp(false);
+    _busyStarted = false; // Wait for the BUSY falling edge of this track
+    _trackLengthMeasured = false;
+  }
+  else if (cmd == DFP_CMD_STOP)
+    muteAmp(true);
+
+  if (_ackPacing)
+    _writeCommandFrame(cmd, param);
+  else if (!_libraryCommand(cmd, param))
+    return;
+
+  switch (cmd)
+  {
+  case DFP_CMD_PLAY:
+    _startTime = _currentTime; // To track file end playing with time...
+    _trackDuration = trackDuration;
+    break;
+  case DFP_CMD_VOLUME:
+    _volumeAmpMute(); // Temporary mute amp if volume is zero
+    break;
+  case DFP_CMD_LOOP:
+    _startTime = _currentTime;
+    _trackDuration = 0; // No need for track duration since looping
+    break;
+  case DFP_CMD_PAUSE:
+    muteAmp(true);
+    break;
+  }
+
+  uint32_t sendTime = micros() - sendStart;
+  _commandsSent++;
+  _commandTimeSum += sendTime;
+  _maxCommandTime = min((uint32_t)0xFFFF, max((uint32_t)_maxCommandTime, sendTime));
 
-  _player.play(track_num);
   _lastCommand = _currentTime; // Note when player's command is passed for delay check
+  if (_isTrackCommand(cmd))
+    _trackCommandTime = _currentTime;
+  _ackPending = _ackPacing;
+
+  _lastCmdRetried = false;
+  _lastCmd = cmd;
+  _lastCmdParam = param;
+  _lastCmdDuration = trackDuration;
+}
 
-  _startTime = _currentTime; // To track file end playing with time...
+// Commands sent by the DFPlayerMini_Fast library, always without feedback
+bool Player::_libraryCommand(uint8_t cmd, uint16_t param)
+{
+  switch (cmd)
+  {
+  case DFP_CMD_NEXT:
+    _player.playNext();
+    break;
+  case DFP_CMD_PREVIOUS:
+    _player.playPrevious();
+    break;
+  case DFP_CMD_PLAY:
+    _player.play(param);
+    break;
+  case DFP_CMD_VOLUME:
+    _player.volume(param);
+    break;
+  case DFP_CMD_LOOP:
+    _player.loop(param);
+    break;
+  case DFP_CMD_PAUSE:
+    _player.pause();
+    break;
+  case DFP_CMD_STOP:
+    _player.stop();
+    break;
+  case DFP_CMD_REPEAT_FOLDER:
+    _player.repeatFolder(param);
+    break;
+  case DFP_CMD_EQ:
+    _player.EQSelect(param);
+    break;
+  case DFP_CMD_PLAYBACK_SOURCE:
+    _player.playbackSource(param);
+    break;
+  case DFP_CMD_REPEAT_PLAY:
+    _player.stopRepeat();
+    break;
+  case DFP_CMD_DAC:
+    _player.startDAC();
+    break;
+  default:
+    return false;
+  }
+  return true;
+}
 
-  uint32_t durationAfterAdvance = track_length - _AUDIO_ADVANCE;
-  uint32_t validDuration = max(0, durationAfterAdvance); // Ensures non-negative value
-  _trackDuration = max(_COMMAND_DELAY, validDuration);   // Ensures it's at least _COMMAND_DELAY
+// Command frame with the feedback flag set, the module acknowledges it with a DFP_REPLY_ACK frame
+void Player::_writeCommandFrame(uint8_t cmd, uint16_t param)
+{
+  uint8_t frame[DFP_FRAME_SIZE] = {DFP_FRAME_START, 0xFF, 0x06, cmd, 0x01, (uint8_t)(param >> 8), (uint8_t)param, 0, 0, DFP_FRAME_END};
+
+  uint16_t sum = 0;
+  for (uint8_t i = 1; i < 7; i++)
+    sum += frame[i];
+  uint16_t checksum = -sum;
+  frame[7] = checksum >> 8;
+  frame[8] = checksum;
+
+  _serial->write(frame, DFP_FRAME_SIZE);
 }
 
-void Player::stop()
+// Queue a command for update(), a newer command supersedes the pending ones it makes useless :
+// a volume replaces the pending volume, a play, loop, stop or pause replaces any pending track command.
+// Next and previous are relative moves and are kept.
+void Player::_queueCommand(uint8_t cmd, uint16_t param)
 {
-  muteAmp(true);
+  bool absoluteTrackCmd = (cmd == DFP_CMD_PLAY || cmd == DFP_CMD_LOOP || cmd == DFP_CMD_STOP || cmd == DFP_CMD_PAUSE);
 
-  _player.stop();
-  _lastCommand = _currentTime; // Note when player's command is passed for delay check
+  for (uint8_t i = 0; i < _queueCount;)
+  {
+    uint8_t queued = _queue[i].cmd;
+    bool trackCmd = _isTrackCommand(queued);
+
+    if (cmd == DFP_CMD_VOLUME && queued == DFP_CMD_VOLUME)
+    {
+      _queue[i].param = param; // Keep its place in the queue
+      _coalesced++;
+      return;
+    }
+
+    if (absoluteTrackCmd && trackCmd)
+    {
+      _removeQueued(i);
+      _coalesced++;
+      continue;
+    }
+    i++;
+  }
+
+  if (_queueCount == PLAYER_QUEUE_SIZE)
+  {
+    _removeQueued(0); // Oldest command lost
+    _dropped++;
+  }
+
+  _queue[_queueCount].cmd = cmd;
+  _queue[_queueCount].param = param;
+  _queue[_queueCount].time = _currentTime;
+  _queueCount++;
+
+  _updateTrackPending();
 }
 
-void Player::pause()
+void Player::_removeQueued(uint8_t index)
 {
-  _player.pause();
-_lastCommand = _currentTime; // Note when player's command is passed for delay check
+  for (uint8_t i = index + 1; i < _queueCount; i++)
+    _queue[i - 1] = _queue[i];
+  _queueCount--;
 
-  muteAmp(true);
-  
+  _updateTrackPending();
 }
 
-void Player::next()
+void Player::_updateTrackPending()
 {
-  muteAmp(false);
- 
-  _player.playNext();
-  _lastCommand = _currentTime; // Note when player's command is passed for delay check
+  // The last queued track command decides, an absolute one has removed the track commands queued before it
+  _trackPending = false;
+  _playPending = false;
+  for (uint8_t i = 0; i < _queueCount; i++)
+  {
+    if (_isTrackCommand(_queue[i].cmd))
+    {
+      _trackPending = true;
+      _playPending = _isPlayCommand(_queue[i].cmd);
+    }
+  }
 }
 
-void Player::previous()
+// Boot sequence step, the player is ready one command delay after the last setup command
+void Player::_processBoot()
 {
-  muteAmp(false);
+  // The module start up delay is always waited before the first command, there is no acknowledge to wait for
+  if (_bootStep == 0 ? _currentTime - _beginTime < _COMMAND_DELAY : !_commandReleased())
+    return;
 
-  _player.playPrevious();
-  _lastCommand = _currentTime; // Note when player's command is passed for delay check
+  switch (_bootStep++)
+  {
+  case 0:
+    _sendCommand(DFP_CMD_VOLUME, _volume);
+    break;
+  case 1:
+    _sendCommand(DFP_CMD_PLAYBACK_SOURCE, 2);
+    break;
+  case 2:
+    _sendCommand(DFP_CMD_EQ, 1);
+    break;
+  case 3:
+    _sendCommand(DFP_CMD_STOP, 0);
+    break;
+  case 4:
+    _sendCommand(DFP_CMD_DAC, 0);
+    break;
+  case 5:
+    _sendCommand(DFP_CMD_REPEAT_PLAY, 0);
+    break;
+  default:
+    _readyTime = _currentTime - _beginTime;
+    break;
+  }
 }
 
-void Player::muteAmp(bool enable) // Cute possible background noise and save power
+// Next command allowed once acknowledged by the module in ACK pacing, else or on a lost acknowledge after the command delay
+bool Player::_commandReleased()
 {
-  if (_mute != enable)
+  // The module may miss a command sent right after a track end
+  if (_BUSY_PIN_ENABLE && _busyStarted && _busyLevel == HIGH && (int32_t)(_currentTime - _busyEndTime) < DFP_BUSY_END_GUARD)
+    return false;
+
+  if (_ackPacing && !_ackPending)
+    return true;
+
+  if (_currentTime - _lastCommand < _COMMAND_DELAY)
+    return false;
+
+  if (_ackPending)
   {
-    _mute = enable;
-    _muteAmp(_mute); // Amp is muted when pin is High
+    _ackTimeouts++;
+    _ackPending = false;
+    DEBUG_PRINTLN("Player acknowledge timeout");
   }
+  return true;
 }
 
-void Player::_muteAmp(bool enable) { digitalWrite(_AMP_MUTE_PIN, enable); } // Amp is muted when pin is High
+// Accept the BUSY level once stable for the glitch filter time, the edge time is the real track start or end
+void Player::_updateBusy()
+{
+  noInterrupts();
+  bool level = _busyRawLevel;
+  uint32_t edgeTime = _busyEdgeTime;
+  uint8_t edges = _busyEdgeCount;
+  interrupts();
 
-void Player::_volumeAmpMute()
+  if (edges == _busyEdges || (int32_t)(_currentTime - edgeTime) < DFP_BUSY_GLITCH_FILTER)
+    return;
+
+  _busyEdges = edges;
+  if (level == _busyLevel)
+  {
+    _busyGlitches++; // Back to the same level before the filter time
+    return;
+  }
+
+  _busyLevel = level;
+  if (level == LOW)
+  {
+    _busyStarted = true;
+    _busyStartTime = edgeTime;
+  }
+  else
+  {
+    _busyEndTime = edgeTime;
+    if (_busyStarted && !_trackLengthMeasured)
+    {
+      _lastTrackLength = min(edgeTime - _busyStartTime, (uint32_t)0xFFFF);
+      _trackLengthMeasured = true;
+    }
+  }
+  DEBUG_PRINTLN(level == LOW ? "Player BUSY start" : "Player BUSY end");
+}
+
+// Time to send the next command for the playing track, from its real start when known
+uint32_t Player::_predictedEnd() const { return (_busyStarted ? _busyStartTime : _startTime) + _trackDuration; }
+
+// Send the oldest queued command once released
+void Player::_processQueue()
 {
-  if (_volume <= 1 && !_mute)
+  if (!_commandReleased() || _queueCount == 0)
+    return;
+
+  PlayerCommand command = _queue[0];
+  _removeQueued(0);
+
+  _maxQueueDelay = max(_maxQueueDelay, (uint16_t)min(_currentTime - command.time, (uint32_t)0xFFFF));
+  // Play commands replace each other in the queue, the pending duration is this one's
+  _sendCommand(command.cmd, command.param, command.cmd == DFP_CMD_PLAY ? _pendingTrackDuration : 0);
+}
+
+void Player::_readReplies()
+{
+  if (!_serial)
+    return;
+
+  // A partial frame with no new byte for a while will never complete
+  if (_rxIndex > 0 && _currentTime - _rxLastByte > DFP_RX_FRAME_TIMEOUT)
   {
-    _muteAmp(true);
+    _rxCorrupted++;
+    _rxIndex = 0;
   }
-  else if (_volume > 1 && !_mute)
+
+  while (_serial->available() > 0)
   {
-    _muteAmp(false);
+    uint8_t b = _serial->read();
+    _rxLastByte = _currentTime;
+
+    // Resync on the start byte
+    if (_rxIndex == 0 && b != DFP_FRAME_START)
+    {
+      _rxCorrupted++;
+      continue;
+    }
+
+    _rxFrame[_rxIndex++] = b;
+    if (_rxIndex == DFP_FRAME_SIZE)
+    {
+      _parseReply();
+      _rxIndex = 0;
+    }
+  }
+}
+
+void Player::_parseReply()
+{
+  uint16_t sum = 0;
+  for (uint8_t i = 1; i < 7; i++)
+    sum += _rxFrame[i];
+  uint16_t checksum = ((uint16_t)_rxFrame[7] << 8) | _rxFrame[8];
+
+  if (_rxFrame[9] != DFP_FRAME_END || (uint16_t)(sum + checksum) != 0)
+  {
+    _rxCorrupted++;
+    DEBUG_PRINTLN("Player corrupted reply frame");
+    return;
+  }
+
+  _rxFrames++;
+
+  // The module answered the last command, acknowledge or error
+  if (_ackPending && (_rxFrame[3] == DFP_REPLY_ACK || _rxFrame[3] == DFP_REPLY_ERROR))
+  {
+    _ackPending = false;
+    _maxAckTime = max(_maxAckTime, (uint16_t)min(_currentTime - _lastCommand, (uint32_t)0xFFFF));
+  }
+
+  // Without BUSY pin, the track length is measured from the play command to the module finished frame,
+  // the module may send it twice
+  if (_rxFrame[3] == DFP_REPLY_TRACK_FINISHED && !_BUSY_PIN_ENABLE && !_trackLengthMeasured)
+  {
+    _lastTrackLength = min(_currentTime - _startTime, (uint32_t)0xFFFF);
+    _trackLengthMeasured = true;
+  }
+
+  // The module received the last command corrupted : send it again, once
+  if (_rxFrame[3] == DFP_REPLY_ERROR && (_rxFrame[6] == DFP_ERROR_FRAME || _rxFrame[6] == DFP_ERROR_CHECKSUM) && !_lastCmdRetried)
+  {
+    _retries++;
+    DEBUG_PRINTLN("Player command retried");
+    _sendCommand(_lastCmd, _lastCmdParam, _lastCmdDuration);
+    _lastCmdRetried = true;
   }
 }
@@ -34,6 +34,49 @@
 #ifndef LOOP
 #define LOOP 1
 #endif
+// DFPlayer serial frames : 7E FF 06 CMD FEEDBACK PARAM_H PARAM_L CHECKSUM_H CHECKSUM_L EF
+#define DFP_FRAME_SIZE 10
+#define DFP_FRAME_START 0x7E
+#define DFP_FRAME_END 0xEF
+#define DFP_RX_FRAME_TIMEOUT 20 // ms, a partial reply frame older than this is dropped as corrupted
+// DFPlayer commands used by the player engine
+#define DFP_CMD_NEXT 0x01
+#define DFP_CMD_PREVIOUS 0x02
+#define DFP_CMD_PLAY 0x03
+#define DFP_CMD_VOLUME 0x06
+#define DFP_CMD_EQ 0x07
+#define DFP_CMD_LOOP 0x08
+#define DFP_CMD_PLAYBACK_SOURCE 0x09
+#define DFP_CMD_PAUSE 0x0E
+#define DFP_CMD_REPEAT_PLAY 0x11
+#define DFP_CMD_STOP 0x16
+#define DFP_CMD_REPEAT_FOLDER 0x17
+#define DFP_CMD_DAC 0x1A
+// Player boot sequence, one command per command delay from update() : volume, source, EQ, stop, DAC, repeat off
+#define PLAYER_BOOT_STEPS 6
+#define PLAYER_BOOT_DONE (PLAYER_BOOT_STEPS + 1)
+// DFPlayer error reply and the errors telling the last command was corrupted on the wire
+#define DFP_REPLY_ERROR 0x40
+#define DFP_REPLY_ACK 0x41 // Acknowledge of a command sent with the feedback flag
+#define DFP_REPLY_TRACK_FINISHED 0x3D // SD card track finished, sent by the module on its own
+#define DFP_ERROR_FRAME 0x03
+#define DFP_ERROR_CHECKSUM 0x04
+// BUSY pin, low while playing : its edges are timestamped by a pin change interrupt and filtered in update()
+#define DFP_BUSY_GLITCH_FILTER 20  // ms a BUSY level must be stable to be accepted
+#define DFP_BUSY_START_TIMEOUT 200 // ms after a track command for BUSY to go low
+#define DFP_BUSY_END_GUARD 50      // ms after a track end while the module may miss commands
+// Commands waiting for the inter commands delay, superseded commands are coalesced so a few entries are enough
+#ifndef PLAYER_QUEUE_SIZE
+#define PLAYER_QUEUE_SIZE 4
+#endif
+
+// Queued player command, time is when it was queued
+struct PlayerCommand
+{
+    uint8_t cmd;
+    uint16_t param;
+    uint32_t time;
+};
 
 class Player
 {
@@ -44,12 +87,33 @@ public:
            const uint8_t pot_pin, const bool volPotEnable,
            const uint8_t commandDelay, 
            const uint8_t audioAdvance,
-           const bool busyPinEneable);
-    bool begin(Stream &s);
+           const bool busyPinEneable,
+           const uint8_t replyWindow);
+    bool begin(Stream &s, bool hardwareSerial = false, bool ackPacing = false);
     void update();
     void update(uint32_t syncCurrentTime);
     bool isPlaying();
-    bool checkCommandDelay();
+    bool isTrackCommandPending() const;
+    uint32_t getTrackCommandTime() const;
+    bool isSerialQuiet() const;
+    bool isReady() const;
+    uint32_t getReadyTime() const;
+    uint8_t getQueuedCommands() const;
+    uint16_t getCoalescedCommands() const;
+    uint16_t getDroppedCommands() const;
+    uint16_t getMaxQueueDelay() const;
+    uint16_t getMaxCommandTime() const;
+    uint16_t getAvgCommandTime() const;
+    uint16_t getAckTimeouts() const;
+    uint16_t getMaxAckTime() const;
+    uint32_t getTimeToEnd();
+    uint32_t getTrackEndTime() const;
+    uint16_t getLastTrackLength() const;
+    bool isTrackLengthMeasured() const;
+    uint16_t getBusyGlitches() const;
+    uint16_t getReceivedFrames() const;
+    uint16_t getCorruptedFrames() const;
+    uint16_t getRetriedCommands() const;
     void setThemesPlaymode();
     void setSinglePlaymode();
     void setCyclingTrackPlaymode();
@@ -79,6 +143,13 @@ private:
     const uint8_t _COMMAND_DELAY;
     const uint8_t _AUDIO_ADVANCE;
     const bool _BUSY_PIN_ENABLE;
+    const uint8_t _REPLY_WINDOW; // ms after a command while the module may answer
+    Stream *_serial;
+    bool _hardwareSerial;    // USART with interrupts driven buffers, else SoftwareSerial
+    bool _ackPacing;         // Commands sent with feedback, the next one is released by the module acknowledge
+    bool _ackPending;
+    uint16_t _ackTimeouts;   // Acknowledges not received within the command delay
+    uint16_t _maxAckTime;    // Longest command to acknowledge time, ms
      uint32_t _currentTime;
     uint32_t _startTime;
     uint32_t _startTimePrev;
@@ -88,9 +159,55 @@ private:
     bool _playing;
     uint16_t _prevAnalogRead;
     uint32_t _lastCommand;
+    uint8_t _lastCmd;        // Last command sent and its parameter, kept to resend it once if the module reports it corrupted
+    uint16_t _lastCmdParam;
+    uint32_t _lastCmdDuration;  // Track duration of the last command if it was a play
+    bool _lastCmdRetried;
+    uint8_t _rxFrame[DFP_FRAME_SIZE]; // Reply frame being received
+    uint8_t _rxIndex;
+    uint32_t _rxLastByte;
+    uint16_t _rxFrames;      // Valid reply frames received
+    uint16_t _rxCorrupted;   // Reply frames dropped : bad checksum, missing end byte, or incomplete
+    uint16_t _retries;       // Commands resent after a corrupted command error reply
+    PlayerCommand _queue[PLAYER_QUEUE_SIZE]; // FIFO, oldest first
+    uint8_t _queueCount;
+    bool _trackPending;             // A track command is queued
+    bool _playPending;              // The last queued track command is a play, loop, next or previous : counts as playing
+    uint32_t _trackCommandTime;     // When the last track command was sent
+    uint32_t _pendingTrackDuration; // Track duration of the queued play command
+    uint16_t _coalesced;            // Queued commands superseded by a newer one
+    uint16_t _dropped;              // Commands dropped on a full queue
+    uint16_t _maxQueueDelay;        // Longest wait in the queue, ms
+    uint8_t _bootStep;              // Next boot sequence command, PLAYER_BOOT_DONE when the player is ready
+    uint32_t _beginTime;
+    uint32_t _readyTime;            // ms from begin() to the end of the boot sequence
+    uint16_t _commandsSent;
+    uint32_t _commandTimeSum;       // CPU time spent sending the commands, us
+    uint16_t _maxCommandTime;
+    bool _busyLevel;                // Filtered BUSY level
+    bool _busyStarted;              // BUSY went low since the last track command
+    uint32_t _busyStartTime;        // BUSY falling edge, the real track start
+    uint32_t _busyEndTime;          // BUSY rising edge, the real track end
+    uint8_t _busyEdges;             // Interrupt edges count already handled
+    uint16_t _busyGlitches;         // BUSY pulses shorter than the filter
+    uint16_t _lastTrackLength;      // Last track length measured between BUSY edges, or to the finished reply frame, ms
+    bool _trackLengthMeasured;      // The track end of the last track command was seen
     bool _mute;
     void _muteAmp(bool enable);
     void _volumeAmpMute();
+    void _sendCommand(uint8_t cmd, uint16_t param, uint32_t trackDuration = 0);
+    bool _libraryCommand(uint8_t cmd, uint16_t param);
+    void _writeCommandFrame(uint8_t cmd, uint16_t param);
+    bool _commandReleased();
+    void _queueCommand(uint8_t cmd, uint16_t param);
+    void _processQueue();
+    void _processBoot();
+    void _updateBusy();
+    uint32_t _predictedEnd() const;
+    void _removeQueued(uint8_t index);
+    void _updateTrackPending();
+    void _readReplies();
+    void _parseReply();
 };
 
 #endif
\ No newline at end of file
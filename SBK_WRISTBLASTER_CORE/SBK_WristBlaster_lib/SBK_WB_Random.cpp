@@ -0,0 +1,63 @@
+/*
+ *  This code is part of SBK_WRISTBLASTER_CORE (VERSION 0), a codebase for animations and effects
+ *  of a Wrist Blaster prop inspired by the movie Ghostbusters: Frozen Empire.
+ *  Copyright (c) 2025 Samuel Barabé
+ *
+ *  For more information, visit the project page: <https://github.com/sbarabe/SBK_WRISTBLASTER_CORE>.
+ *
+ *  This work is licensed under the Creative Commons Attribution 4.0 International License (CC BY 4.0).
+ *  You are free to share, copy, and modify this code as long as appropriate credit is given to the author.
+ *  See the full license at: <https://creativecommons.org/licenses/by/4.0/>.
+ *
+ *  This code is provided "as-is" without any warranty of any kind, either expressed or implied,
+ *  including but not limited to the warranties of merchantability or fitness for a particular purpose.
+ *  See the full license text for more details.
+ */
+
+#include "SBK_WB_Random.h"
+
+uint32_t FastRandom::_state = FAST_RANDOM_DEFAULT_SEED;
+
+// A zero state would stay zero forever
+void FastRandom::seed(uint32_t seed) { _state = seed ? seed : FAST_RANDOM_DEFAULT_SEED; }
+
+// 16 random bits, the high half of the xorshift32 state
+uint16_t FastRandom::next()
+{
+    uint32_t x = _state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    _state = x;
+    return x >> 16;
+}
+
+// Random value in [0, bound) : draws masked to the bound bit width are rejected until one fits,
+// less than two draws on average
+uint16_t FastRandom::below(uint16_t bound)
+{
+    if (bound <= 1)
+        return 0;
+
+    uint16_t mask = bound - 1;
+    mask |= mask >> 1;
+    mask |= mask >> 2;
+    mask |= mask >> 4;
+    mask |= mask >> 8;
+
+    uint16_t value;
+    do
+        value = next() & mask;
+    while (value >= bound);
+
+    return value;
+}
+
+// Random value in [low, high), like Arduino random(low, high)
+int16_t FastRandom::range(int16_t low, int16_t high)
+{
+    if (high <= low)
+        return low;
+
+    return low + (int16_t)below((uint16_t)(high - low));
+}
@@ -0,0 +1,43 @@
+/*
+ *  This code is part of SBK_WRISTBLASTER_CORE (VERSION 0), a codebase for animations and effects
+ *  of a Wrist Blaster prop inspired by the movie Ghostbusters: Frozen Empire.
+ *  Copyright (c) 2025 Samuel Barabé
+ *
+ *  For more information, visit the project page: <https://github.com/sbarabe/SBK_WRISTBLASTER_CORE>.
+ *
+ *  This work is licensed under the Creative Commons Attribution 4.0 International License (CC BY 4.0).
+ *  You are free to share, copy, and modify this code as long as appropriate credit is given to the author.
+ *  See the full license at: <https://creativecommons.org/licenses/by/4.0/>.
+ *
+ *  This code is provided "as-is" without any warranty of any kind, either expressed or implied,
+ *  including but not limited to the warranties of merchantability or fitness for a particular purpose.
+ *  See the full license text for more details.
+ */
+
+#ifndef SBK_WB_RANDOM_H
+#define SBK_WB_RANDOM_H
+
+#include <Arduino.h>
+
+/*************************************************************************************************************/
+/*   Shared fast random numbers for the animations : xorshift32 generator, bounded draws by masking and      */
+/*   rejection (unbiased, no division). Same sequence for a given seed, for deterministic replays.          */
+/*************************************************************************************************************/
+
+#ifndef FAST_RANDOM_DEFAULT_SEED
+#define FAST_RANDOM_DEFAULT_SEED 0x2545F491UL
+#endif
+
+class FastRandom
+{
+public:
+    static void seed(uint32_t seed);
+    static uint16_t next();
+    static uint16_t below(uint16_t bound);
+    static int16_t range(int16_t low, int16_t high);
+
+private:
+    static uint32_t _state;
+};
+
+#endif
@@ -28,8 +28,10 @@
 /*  HELPERS  */
 const uint8_t FIRE_STROBE_WHITE_COMPONENT = 0; // 0-255, increasing this increase the white level of the firing strobe.
 const uint8_t DEFAULT_HUE = 42;
+const uint8_t HUE_POT_INTERVAL = 100;  // ms between two hue potentiometer samples
+const uint8_t HUE_POT_HYSTERESIS = 8; // Potentiometer reading change (0-1023) ignored as noise
 
-FiringRod::FiringRod(Adafruit_NeoPixel *strip,
+FiringRod::FiringRod(LedsChain *strip,
                      const uint8_t potPin, const bool potEnable,
                      const uint8_t *numLeds, const uint8_t *start, const uint8_t *end)
     : LedsStrip(strip),
@@ -37,21 +39,12 @@ FiringRod::FiringRod(Adafruit_NeoPixel *strip,
       _POT_ENABLE(potEnable),
       P_NUMLEDS(numLeds), P_START(start), P_END(end),
       _tg_brightness(0), _brightness(0),
-      _ini_brightness(0),
       _shuffle(true),
       _strobeSpeed(10),
-      _hue(42) // Purple hue aka red and blue
+      _hue(DEFAULT_HUE), // Purple hue aka red and blue
+      _prevPotValue(0), _prevPotRead(0)
 {
-    _ini_r = new uint8_t[*P_NUMLEDS];
-    _ini_g = new uint8_t[*P_NUMLEDS];
-    _ini_b = new uint8_t[*P_NUMLEDS];
-}
-
-FiringRod::~FiringRod()
-{
-    delete[] _ini_r;
-    delete[] _ini_g;
-    delete[] _ini_b;
+    _hueToRGB(_hue, _hueR, _hueG, _hueB);
 }
 
 void FiringRod::begin()
@@ -85,28 +78,24 @@ void FiringRod::strobeInit(bool shuffle, uint8_t tg_brightness)
 void FiringRod::strobeInit(bool shuffle, uint8_t tg_brightness, uint16_t rampTime)
 {
     _iniTime = _currentTime;
-    _ini_brightness = _brightness;
     _shuffle = shuffle;
 
-    // Read potentiometer and map it to a hue range (0-255)
-
-    _hue = _getHue();
-    uint8_t r, g, b;
-    _hueToRGB(_hue, r, g, b);
+    // Read potentiometer now for the new strobe hue
+    _updateHue(true);
 
-    // Set initial colors
+    // Set initial colors, kept in the chain framebuffer
     for (uint8_t i = 0; i < *P_NUMLEDS; i++)
     {
-        _ini_r[i] = _randomScaledBrightness(r);
-        _ini_g[i] = _randomScaledBrightness(g);
-        _ini_b[i] = _randomScaledBrightness(b);
-
-        _setColor(*P_START+i, _ini_r[i], _ini_g[i], _ini_b[i]);
+        _setColor(*P_START+i,
+                  _randomScaledBrightness(_hueR),
+                  _randomScaledBrightness(_hueG),
+                  _randomScaledBrightness(_hueB));
     }
 
     // Boundaries check
     _tg_brightness = constrain(tg_brightness, 0, 100);
     _rampTime = max(0, rampTime);
+    _brightnessRamp.init(_brightness, _tg_brightness, _rampTime, _iniTime, _updateSpeed);
 
     // If no ramp time, set the brightness
     if (rampTime == 0)
@@ -119,19 +108,17 @@ void FiringRod::strobe()
 
     if (_currentTime - _prevUpdate > _strobeSpeed)
     {
-        _strobeSpeed = random(_updateSpeed, 50);
+        _strobeSpeed = FastRandom::range(_updateSpeed, 50);
 
         _prevUpdate = _currentTime;
 
-        _hue = _getHue();
-        uint8_t r, g, b;
-        _hueToRGB(_hue, r, g, b);
+        _updateHue(false);
 
         if (_brightness != _tg_brightness)
-            _brightness = _rampParameter(_iniTime, _rampTime, _ini_brightness, _tg_brightness, _updateSpeed);
+            _brightness = _brightnessRamp.step(_currentTime);
 
         // Select the LED(s) to update
-        int ledIndex = _shuffle ? random(0, *P_NUMLEDS - 1) : -1;
+        int ledIndex = _shuffle ? FastRandom::range(0, *P_NUMLEDS - 1) : -1;
 
         for (uint8_t i = 0; i < *P_NUMLEDS; i++)
         {
@@ -139,9 +126,9 @@ void FiringRod::strobe()
                 continue; // Only update one LED in shuffle mode
 
             _setColor(*P_START+i,
-                      _randomScaledBrightness(r),
-                      _randomScaledBrightness(g),
-                      _randomScaledBrightness(b));
+                      _randomScaledBrightness(_hueR),
+                      _randomScaledBrightness(_hueG),
+                      _randomScaledBrightness(_hueB));
 
             if (_shuffle)
                 break; // Exit after updating one LED
@@ -151,18 +138,33 @@ void FiringRod::strobe()
 
 uint8_t FiringRod::_randomScaledBrightness(uint8_t colorComponent)
 {
-    return (_brightness * random(FIRE_STROBE_WHITE_COMPONENT, max(FIRE_STROBE_WHITE_COMPONENT, colorComponent))) / 100;
+    return (_brightness * FastRandom::range(FIRE_STROBE_WHITE_COMPONENT, max(FIRE_STROBE_WHITE_COMPONENT, colorComponent))) / 100;
 }
 
-uint8_t FiringRod::_getHue()
+void FiringRod::_updateHue(bool force)
 {
     if (!_POT_ENABLE)
-        return DEFAULT_HUE;
+        return; // Default hue color set at construction
+
+    // Low rate sampling, the conversion blocks for ~100us
+    if (!force && _currentTime - _prevPotRead < HUE_POT_INTERVAL)
+        return;
+    _prevPotRead = _currentTime;
+
+    uint16_t potValue = analogRead(_POT_PIN);
+
+    // Hysteresis : pot noise around a position doesn't change the hue
+    if (!force && abs((int16_t)potValue - (int16_t)_prevPotValue) <= HUE_POT_HYSTERESIS)
+        return;
+    _prevPotValue = potValue;
 
-    int potValue = analogRead(_POT_PIN);
-    uint8_t hue = map(potValue, 0, 1023, 0, 255);
+    // Map the potentiometer to the hue range (0-255), color only recomputed on change
+    uint8_t hue = potValue >> 2;
+    if (hue == _hue)
+        return;
 
-    return hue;
+    _hue = hue;
+    _hueToRGB(_hue, _hueR, _hueG, _hueB);
 }
 
 void FiringRod::_hueToRGB(uint8_t hue, uint8_t &r, uint8_t &g, uint8_t &b)
@@ -20,6 +20,7 @@
 #include "Arduino.h"
 #include <Adafruit_NeoPixel.h>
 #include "SBK_WB_LedsStripBaseEngine.h"
+#include "SBK_WB_Random.h"
 
 /* GENERAL HELPERS */
 #ifndef DISABLE
@@ -48,10 +49,9 @@
 class FiringRod : public LedsStrip
 {
 public:
-    FiringRod(Adafruit_NeoPixel *strip,
+    FiringRod(LedsChain *strip,
               const uint8_t potPin, const bool potEnable,
               const uint8_t *numLeds, const uint8_t *start, const uint8_t *end);
-    ~FiringRod();
     void begin();
     void clear();
     void strobeInit();
@@ -64,13 +64,15 @@ private:
     const uint8_t _POT_PIN;
     const bool _POT_ENABLE;
     const uint8_t *P_NUMLEDS, *P_START, *P_END;
-    uint8_t *_ini_r, *_ini_g, *_ini_b;
     uint8_t _tg_brightness, _brightness;
-    uint8_t _ini_brightness;
+    LedsRamp _brightnessRamp;
     bool _shuffle;
     uint8_t _strobeSpeed;
     uint8_t _hue;
-    uint8_t _getHue();
+    uint8_t _hueR, _hueG, _hueB; // Cached hue color, only recomputed when the hue changes
+    uint16_t _prevPotValue;
+    uint32_t _prevPotRead;
+    void _updateHue(bool force);
     void _hueToRGB(uint8_t hue, uint8_t &r, uint8_t &g, uint8_t &b);
     uint8_t _randomScaledBrightness(uint8_t colorComponent);
 };
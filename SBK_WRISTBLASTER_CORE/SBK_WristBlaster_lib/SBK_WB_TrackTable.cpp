@@ -0,0 +1,109 @@
+/*
+ *  This code is part of SBK_WRISTBLASTER_CORE (VERSION 0), a codebase for animations and effects
+ *  of a Wrist Blaster prop inspired by the movie Ghostbusters: Frozen Empire.
+ *  Copyright (c) 2025 Samuel Barabé
+ *
+ *  For more information, visit the project page: <https://github.com/sbarabe/SBK_WRISTBLASTER_CORE>.
+ *
+ *  This work is licensed under the Creative Commons Attribution 4.0 International License (CC BY 4.0).
+ *  You are free to share, copy, and modify this code as long as appropriate credit is given to the author.
+ *  See the full license at: <https://creativecommons.org/licenses/by/4.0/>.
+ *
+ *  This code is provided "as-is" without any warranty of any kind, either expressed or implied,
+ *  including but not limited to the warranties of merchantability or fitness for a particular purpose.
+ *  See the full license text for more details.
+ */
+
+#include "SBK_WB_TrackTable.h"
+#include <EEPROM.h>
+
+/* DEBUG MESSAGES TO SERIAL */
+// comment/uncomment #define DEBUG_TO_SERIAL to receive serial message
+
+// #define DEBUG_TO_SERIAL
+#ifdef DEBUG_TO_SERIAL
+#define DEBUG_PRINTLN(x) Serial.println(x)
+#define DEBUG_PRINT(x) Serial.print(x)
+#else
+#define DEBUG_PRINTLN(x)
+#define DEBUG_PRINT(x)
+#endif
+
+TrackTable::TrackTable(const uint16_t *defaultLengths, uint16_t *lengths, uint8_t tracksNumber, uint16_t eepromAddress)
+    : P_DEFAULT_LENGTHS(defaultLengths),
+      _lengths(lengths),
+      _TRACKS_NUMBER(tracksNumber),
+      _EEPROM_ADDRESS(eepromAddress),
+      _calibrated(false)
+{
+}
+
+// Load the calibrated lengths from EEPROM, or the config lengths if the EEPROM table is missing or corrupted
+bool TrackTable::begin()
+{
+    uint16_t magic;
+    uint16_t checksum;
+    uint16_t address = _EEPROM_ADDRESS;
+
+    EEPROM.get(address, magic);
+    address += sizeof(magic);
+    uint8_t tracksNumber = EEPROM.read(address++);
+    for (uint8_t i = 0; i < _TRACKS_NUMBER; i++, address += sizeof(uint16_t))
+        EEPROM.get(address, _lengths[i]);
+    EEPROM.get(address, checksum);
+
+    _calibrated = (magic == TRACK_TABLE_MAGIC && tracksNumber == _TRACKS_NUMBER && checksum == _checksum());
+    if (!_calibrated)
+        memcpy(_lengths, P_DEFAULT_LENGTHS, _TRACKS_NUMBER * sizeof(uint16_t));
+
+    DEBUG_PRINTLN(_calibrated ? "Track lengths loaded from EEPROM" : "Track lengths from config");
+    return _calibrated;
+}
+
+uint16_t TrackTable::get(uint8_t track) const { return track < _TRACKS_NUMBER ? _lengths[track] : 0; }
+
+void TrackTable::set(uint8_t track, uint16_t length)
+{
+    if (track < _TRACKS_NUMBER)
+        _lengths[track] = length;
+}
+
+bool TrackTable::isCalibrated() const { return _calibrated; }
+
+// Write the table, EEPROM.put() only rewrites the bytes that changed
+void TrackTable::save()
+{
+    uint16_t address = _EEPROM_ADDRESS;
+
+    EEPROM.put(address, (uint16_t)TRACK_TABLE_MAGIC);
+    address += sizeof(uint16_t);
+    EEPROM.update(address++, _TRACKS_NUMBER);
+    for (uint8_t i = 0; i < _TRACKS_NUMBER; i++, address += sizeof(uint16_t))
+        EEPROM.put(address, _lengths[i]);
+    EEPROM.put(address, _checksum());
+
+    _calibrated = true;
+}
+
+// Invalidate the EEPROM table, the config lengths are used from the next start-up
+void TrackTable::erase()
+{
+    EEPROM.put(_EEPROM_ADDRESS, (uint16_t)0xFFFF);
+    _calibrated = false;
+}
+
+// Fletcher-16 of the tracks number and the lengths bytes
+uint16_t TrackTable::_checksum() const
+{
+    uint16_t sum1 = _TRACKS_NUMBER;
+    uint16_t sum2 = sum1;
+
+    for (uint8_t i = 0; i < _TRACKS_NUMBER; i++)
+    {
+        sum1 = (sum1 + (_lengths[i] & 0xFF)) % 255;
+        sum2 = (sum2 + sum1) % 255;
+        sum1 = (sum1 + (_lengths[i] >> 8)) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    return (sum2 << 8) | sum1;
+}
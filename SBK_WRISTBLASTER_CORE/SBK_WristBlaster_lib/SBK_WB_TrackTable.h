@@ -0,0 +1,68 @@
+/*
+ *  This code is part of SBK_WRISTBLASTER_CORE (VERSION 0), a codebase for animations and effects
+ *  of a Wrist Blaster prop inspired by the movie Ghostbusters: Frozen Empire.
+ *  Copyright (c) 2025 Samuel Barabé
+ *
+ *  For more information, visit the project page: <https://github.com/sbarabe/SBK_WRISTBLASTER_CORE>.
+ *
+ *  This work is licensed under the Creative Commons Attribution 4.0 International License (CC BY 4.0).
+ *  You are free to share, copy, and modify this code as long as appropriate credit is given to the author.
+ *  See the full license at: <https://creativecommons.org/licenses/by/4.0/>.
+ *
+ *  This code is provided "as-is" without any warranty of any kind, either expressed or implied,
+ *  including but not limited to the warranties of merchantability or fitness for a particular purpose.
+ *  See the full license text for more details.
+ */
+
+#ifndef SBK_WB_TRACKTABLE_H
+#define SBK_WB_TRACKTABLE_H
+
+#include <Arduino.h>
+
+/*************************************************************************************************************/
+/*   Tracks lengths table : measured lengths saved in EEPROM by the calibration mode are loaded at start-up, */
+/*   the config lengths are used when the EEPROM holds no valid table for this tracks number.                */
+/*   EEPROM layout : magic, tracks number, lengths (ms), Fletcher-16 checksum of the tracks number and       */
+/*   lengths.                                                                                                */
+/*************************************************************************************************************/
+
+#define TRACK_TABLE_MAGIC 0x544C // "TL"
+// EEPROM bytes used by a table of this tracks number
+#define TRACK_TABLE_EEPROM_SIZE(tracks) (2 + 1 + 2 * (tracks) + 2)
+
+class TrackTable
+{
+public:
+    TrackTable(const uint16_t *defaultLengths, uint16_t *lengths, uint8_t tracksNumber, uint16_t eepromAddress);
+    bool begin();
+    uint16_t get(uint8_t track) const;
+    void set(uint8_t track, uint16_t length);
+    bool isCalibrated() const;
+    void save();
+    void erase();
+
+private:
+    const uint16_t *P_DEFAULT_LENGTHS;
+    uint16_t *_lengths;
+    const uint8_t _TRACKS_NUMBER;
+    const uint16_t _EEPROM_ADDRESS;
+    bool _calibrated; // Lengths loaded from or saved to EEPROM
+
+    uint16_t _checksum() const;
+};
+
+template <uint8_t TRACKS>
+class TrackLengths : public TrackTable
+{
+public:
+    TrackLengths(const uint16_t *defaultLengths, uint16_t eepromAddress)
+        : TrackTable(defaultLengths, _lengthsStorage, TRACKS, eepromAddress),
+          _lengthsStorage{0}
+    {
+    }
+
+private:
+    uint16_t _lengthsStorage[TRACKS];
+};
+
+#endif
@@ -25,14 +25,12 @@
 #define DEBUG_PRINT(x)
 #endif
 
-Vent::Vent(Adafruit_NeoPixel *strip, const uint8_t *pixel)
+Vent::Vent(LedsChain *strip, const uint8_t *pixel)
     : LedsStrip(strip),
       P_PIXEL(pixel),
       _rPrev(0), _gPrev(0), _bPrev(0),
       _tg_brightness(0),
-      _ini_r(0), _tg_r(0),
-      _ini_g(0), _tg_g(0),
-      _ini_b(0), _tg_b(0),
+      _tg_r(0), _tg_g(0), _tg_b(0),
       _flickerSpeed(10)
 {
 }
@@ -82,10 +80,10 @@ void Vent::initParam(const uint8_t color[3], uint8_t tg_brightness, int16_t ramp
   uint8_t currentRed, currentGreen, currentBlue;
   _getCurrentColor(*P_PIXEL, currentRed, currentGreen, currentBlue);
 
-  // Record initial vent color trackers
-  _ini_r = currentRed;
-  _ini_g = currentGreen;
-  _ini_b = currentBlue;
+  // Ramps from the current vent color
+  _rRamp.init(currentRed, _tg_r, _rampTime, _iniTime, _updateSpeed);
+  _gRamp.init(currentGreen, _tg_g, _rampTime, _iniTime, _updateSpeed);
+  _bRamp.init(currentBlue, _tg_b, _rampTime, _iniTime, _updateSpeed);
 }
 
 void Vent::solid()
@@ -100,16 +98,16 @@ void Vent::flicker(uint8_t flickerAmount, uint16_t maxSpeed)
   {
     _prevUpdate = _currentTime;
 
-    _flickerSpeed = random(_updateSpeed, maxSpeed);
+    _flickerSpeed = FastRandom::range(_updateSpeed, maxSpeed);
 
     // Generate random brightness variation within flickerAmount
-    int8_t variation = random(-_tg_brightness * flickerAmount / 100, _tg_brightness * flickerAmount / 100);
+    int8_t variation = FastRandom::range(-_tg_brightness * flickerAmount / 100, _tg_brightness * flickerAmount / 100);
     uint8_t flickerBrightness = constrain(_tg_brightness + variation, 0, 100);
 
     // Calculate flickered color based on brightness variation
-    uint8_t flicker_r = constrain((_tg_r * flickerBrightness) / 100 + random(-15, 15), 0, 255);
-    uint8_t flicker_g = constrain((_tg_g * flickerBrightness) / 100 + random(-15, 15), 0, 255);
-    uint8_t flicker_b = constrain((_tg_b * flickerBrightness) / 100 + random(-15, 15), 0, 255);
+    uint8_t flicker_r = constrain((_tg_r * flickerBrightness) / 100 + FastRandom::range(-15, 15), 0, 255);
+    uint8_t flicker_g = constrain((_tg_g * flickerBrightness) / 100 + FastRandom::range(-15, 15), 0, 255);
+    uint8_t flicker_b = constrain((_tg_b * flickerBrightness) / 100 + FastRandom::range(-15, 15), 0, 255);
 
     // Apply the flicker effect
     _setColor(*P_PIXEL, flicker_r, flicker_g, flicker_b);
@@ -139,9 +137,9 @@ bool Vent::ramp()
     _prevUpdate = _currentTime;
 
     _setColor(*P_PIXEL,
-              _rampParameter(_iniTime, _rampTime, _ini_r, _tg_r, _updateSpeed),
-              _rampParameter(_iniTime, _rampTime, _ini_g, _tg_g, _updateSpeed),
-              _rampParameter(_iniTime, _rampTime, _ini_b, _tg_b, _updateSpeed));
+              _rRamp.step(_currentTime),
+              _gRamp.step(_currentTime),
+              _bRamp.step(_currentTime));
   }
 
   return false;
@@ -20,6 +20,7 @@
 #include <Arduino.h>
 #include <Adafruit_NeoPixel.h>
 #include "SBK_WB_LedsStripBaseEngine.h"
+#include "SBK_WB_Random.h"
 
 /* GENERAL HELPERS */
 #ifndef DISABLE
@@ -41,7 +42,7 @@
 class Vent : public LedsStrip
 {
 public:
-    Vent(Adafruit_NeoPixel *strip, const uint8_t *pixel);
+    Vent(LedsChain *strip, const uint8_t *pixel);
     void begin();
     void clear();
     void initParam(const uint8_t color[3], uint8_t tg_brightness);
@@ -54,9 +55,8 @@ private:
     const uint8_t *P_PIXEL;
     uint8_t _rPrev, _gPrev, _bPrev;
     uint8_t _tg_brightness;
-    uint8_t _ini_r, _tg_r;
-    uint8_t _ini_g, _tg_g;
-    uint8_t _ini_b, _tg_b;
+    uint8_t _tg_r, _tg_g, _tg_b;
+    LedsRamp _rRamp, _gRamp, _bRamp;
     uint8_t _flickerSpeed;
 };
 